@@ -1,5 +1,5 @@
 #include "FlowField.h"
-#include <queue>
+#include <algorithm>
 
 FlowField::FlowField()
 {
@@ -35,7 +35,7 @@ FlowField::FlowField()
 	m_goal = m_goalCircle.getPosition();
 
 	makeCostsField();
-	makeIntegrationFieldBFS();
+	makeIntegrationField();
 	makeFlowField();
 
 }
@@ -44,7 +44,7 @@ void FlowField::update(float dt)
 {
 	if (fieldNeedsUpdate)
 	{
-		makeIntegrationFieldBFS();
+		makeIntegrationField();
 		makeFlowField();
 		updateCostTexts();
 		fieldNeedsUpdate = false;
@@ -289,15 +289,18 @@ void FlowField::toggleObstacleAtPosition(sf::Vector2f position)
 	//toggle between obstacle and normal cost
 	m_costs[index] = (m_costs[index] == 1.f) ? 9999.f : 1.f;
 
-	//updates the field
-	fieldNeedsUpdate = true;
+	//a* fields depend on the order cells were found so they cant be repaired, nor can one thats out of date
+	if (useAStar || fieldNeedsUpdate)
+		fieldNeedsUpdate = true;
+	else
+		repairField(index);
 
 }
 
 void FlowField::togglePathfinding()
 {
 	useAStar = !useAStar;
-	makeIntegrationFieldBFS();
+	makeIntegrationField();
 	makeFlowField();
 	updateCostTexts();
 }
@@ -308,10 +311,9 @@ void FlowField::toggleHeatMap()
 }
 
 
-std::vector<sf::Vector2f> FlowField::getNeighbours(sf::Vector2f cell)
+void FlowField::getNeighbours(sf::Vector2f cell, std::vector<sf::Vector2f>& neighbours)
 {
-
-	std::vector<sf::Vector2f> neighbours;
+	neighbours.clear();
 	//check all 8 possible neighbours if 0,0 thats where you are now, gets rid of neighbours outside grid
 	for (int j = -1; j <= 1; ++j)
 	{
@@ -339,8 +341,6 @@ std::vector<sf::Vector2f> FlowField::getNeighbours(sf::Vector2f cell)
 			neighbours.push_back(sf::Vector2f(static_cast<float>(neighbourX), static_cast<float>(neighbourY)));
 		}
 	}
-
-	return neighbours;
 }
 
 float FlowField::heuristic(sf::Vector2f from, sf::Vector2f to)
@@ -373,148 +373,311 @@ void FlowField::makeCostsField()
 
 }
 
-void FlowField::makeIntegrationFieldBFS()
+void FlowField::makeIntegrationField()
 {
+	sf::Clock clock;
+	m_pushes = 0;
+	m_relaxations = 0;
+	m_settled = 0;
+
 	if (useAStar)
 	{
 		makeIntegrationFieldAStar();
 		std::cout << " Using A*";
 	}
-	else{
-		std::cout << "Using BFS";
-		//sets all to high cost
-		m_integration.assign(cols * rows, 999999.f);
-
-		int goalIndex = cellGoalY * cols + cellGoalX;
-		if (goalIndex < 0 || goalIndex >= cols * rows)
-			return;
-		// marks it at the bottom (low)
-		m_integration[goalIndex] = 0.f;
-		
-		std::queue<sf::Vector2f> open;
-		open.push(sf::Vector2f(static_cast<float>(cellGoalX), static_cast<float>(cellGoalY)));
-		
-		while (!open.empty())
-		{
-			auto current = open.front();
-			open.pop();
-			int currentIndex = current.y * cols + current.x;
-			//for each neighbour get current valdi neighbour
-			for (auto& neighbor : getNeighbours(sf::Vector2f((float)current.x, (float)current.y)))
-			{
-				int neighbourX = (int)neighbor.x;
-				int neighbourY = (int)neighbor.y;
-				int neighbourIndex = neighbourY * cols + neighbourX;
+	else
+	{
+		makeIntegrationFieldDijkstra();
+		m_rhs = m_integration;
+		std::cout << "Using Dijkstra";
+	}
+	std::cout << ": " << m_settled << " settled, " << m_relaxations << " relaxations, " << m_pushes << " pushes, "
+		<< clock.getElapsedTime().asMicroseconds() << " us\n";
+}
 
-				if (m_costs[neighbourIndex] >= 9999.f)
-					continue;
+void FlowField::makeIntegrationFieldDijkstra()
+{
+	//sets all to high cost
+	m_integration.assign(cols * rows, 999999.f);
 
-				// Euclidean distance calculation what cost to reach current cell and cost of moving to this neighbour
-				sf::Vector2f offset = neighbor - current;
-				float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
+	int goalIndex = cellGoalY * cols + cellGoalX;
+	if (goalIndex < 0 || goalIndex >= cols * rows)
+		return;
+	// marks it at the bottom (low)
+	m_integration[goalIndex] = 0.f;
 
-				float newCost = m_integration[currentIndex] + m_costs[neighbourIndex] + euclideanDistance;
-				//if its lower update and add to open list
-				if (newCost < m_integration[neighbourIndex])
-				{
-					m_integration[neighbourIndex] = newCost;
-					open.push(sf::Vector2f(static_cast<float>(neighbourX), static_cast<float>(neighbourY)));
+	//always takes the cheapest cell next, every cost is positive so nothing cheaper
+	//can reach it later, its final the first time its taken and never goes back in
+	m_open.reset(cols * rows);
+	m_open.pushOrDecrease(goalIndex, 0.f);
+	m_pushes++;
 
-				}
+	std::vector<sf::Vector2f> neighbours;
+	while (!m_open.empty())
+	{
+		int currentIndex = m_open.pop();
+		m_settled++;
+		sf::Vector2f current(static_cast<float>(currentIndex % cols), static_cast<float>(currentIndex / cols));
+		//for each neighbour get current valdi neighbour
+		getNeighbours(current, neighbours);
+		for (auto& neighbor : neighbours)
+		{
+			int neighbourIndex = static_cast<int>(neighbor.y) * cols + static_cast<int>(neighbor.x);
+
+			if (m_costs[neighbourIndex] >= 9999.f)
+				continue;
+
+			// Euclidean distance calculation what cost to reach current cell and cost of moving to this neighbour
+			sf::Vector2f offset = neighbor - current;
+			float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
+
+			float newCost = m_integration[currentIndex] + m_costs[neighbourIndex] + euclideanDistance;
+			//if its lower update it, its either added or moved up the open list
+			if (newCost < m_integration[neighbourIndex])
+			{
+				m_integration[neighbourIndex] = newCost;
+				m_relaxations++;
+				if (m_open.pushOrDecrease(neighbourIndex, newCost))
+					m_pushes++;
 			}
 		}
 	}
-	
 }
 
 void FlowField::makeIntegrationFieldAStar()
 {
-	//same as bfs but using a priority queue and heuristic goal starts at 0 and rest massive
-     m_integration.assign(cols * rows, 999999.f);
-     int goalIndex = cellGoalY * cols + cellGoalX;
-   if (goalIndex < 0 || goalIndex >= cols * rows)
-	return;
-   m_integration[goalIndex] = 0.f;
-
-  std::priority_queue<Node, std::vector<Node>, std::greater<Node>> open;
-  //processed nodes
-  std::vector<bool> closed(cols * rows, false);
-  sf::Vector2f goalCell(static_cast<float>(cellGoalX), static_cast<float>(cellGoalY));
-  sf::Vector2f startCell(static_cast<float>(cellX), static_cast<float>(cellY));
-
-  float hCostStart = heuristic(goalCell,startCell);
-  //push goal node to the start of the list 
-  open.push(Node(goalCell, 0.f, hCostStart));
-  
-  while (!open.empty()) {
-	  //always process the node with the lowest f cost
-	  Node current = open.top();
-
-	  open.pop();
-
-	  int currentIndex = static_cast<int>(current.cell.y) * cols + static_cast<int>(current.cell.x);
-	  //if its clised then skip
-	  if (closed[currentIndex])
-		  continue;
-	  closed[currentIndex] = true; //mark it closed
-	  for (auto& neighbour : getNeighbours(current.cell)) {
-		  //for each neighbour get current valdi neighbour
-
-		  int neighbourX = static_cast<int>(neighbour.x);
-		  int neighbourY = static_cast<int>(neighbour.y);
-		  int neighbourIndex = neighbourY * cols + neighbourX;
-		  //if its an obstacle or closed skip
-		  if (m_costs[neighbourIndex] >= 9999.f || closed[neighbourIndex]) {
-			  continue;
-		  }
-		  // cost evaluation to reach neighbout
-		  sf::Vector2f offset = neighbour - current.cell;
-		  float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
-		  float newCost = m_integration[currentIndex] + m_costs[neighbourIndex] + euclideanDistance;
-		  //if its lower update and add to open list
-		  if (newCost < m_integration[neighbourIndex]) {
-			  m_integration[neighbourIndex] = newCost;
-			  float hCost = heuristic(neighbour, startCell);
-			  open.push(Node(neighbour, newCost, hCost));
-		  }
-	  }
-  }
+	//same as dijkstra but ordered by cost plus heuristic goal starts at 0 and rest massive
+	m_integration.assign(cols * rows, 999999.f);
+	int goalIndex = cellGoalY * cols + cellGoalX;
+	if (goalIndex < 0 || goalIndex >= cols * rows)
+		return;
+	m_integration[goalIndex] = 0.f;
 
+	//processed nodes
+	std::vector<bool> closed(cols * rows, false);
+	sf::Vector2f startCell(static_cast<float>(cellX), static_cast<float>(cellY));
 
+	//push goal node to the start of the list
+	m_open.reset(cols * rows);
+	m_open.pushOrDecrease(goalIndex, heuristic(sf::Vector2f(static_cast<float>(cellGoalX), static_cast<float>(cellGoalY)), startCell));
+	m_pushes++;
+
+	std::vector<sf::Vector2f> neighbours;
+	while (!m_open.empty()) {
+		//always process the node with the lowest f cost, each cell is only in the list once
+		int currentIndex = m_open.pop();
+		m_settled++;
+		closed[currentIndex] = true; //mark it closed
+		sf::Vector2f current(static_cast<float>(currentIndex % cols), static_cast<float>(currentIndex / cols));
+
+		getNeighbours(current, neighbours);
+		for (auto& neighbour : neighbours) {
+			//for each neighbour get current valdi neighbour
+			int neighbourIndex = static_cast<int>(neighbour.y) * cols + static_cast<int>(neighbour.x);
+			//if its an obstacle or closed skip
+			if (m_costs[neighbourIndex] >= 9999.f || closed[neighbourIndex]) {
+				continue;
+			}
+			// cost evaluation to reach neighbout
+			sf::Vector2f offset = neighbour - current;
+			float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
+			float newCost = m_integration[currentIndex] + m_costs[neighbourIndex] + euclideanDistance;
+			//if its lower update and add it or move it up the open list
+			if (newCost < m_integration[neighbourIndex]) {
+				m_integration[neighbourIndex] = newCost;
+				m_relaxations++;
+				if (m_open.pushOrDecrease(neighbourIndex, newCost + heuristic(neighbour, startCell)))
+					m_pushes++;
+			}
+		}
+	}
 }
 
 void FlowField::makeFlowField()
 {
 	//starts with no direction
 	m_directions.resize(cols * rows, sf::Vector2f(0.f, 0.f));
+	std::vector<sf::Vector2f> neighbours;
 	//for each cell find lowest cost neighbour and set direction to it
-	for (int y = 0; y < rows; ++y)
-		for (int x = 0; x < cols; ++x) {
-			//get index of current cell
-			int index = y * cols + x;
-			//set the lowest cost to current cell
-			float lowestCost = m_integration[index];
-
-			sf::Vector2f bestDirection(0.f, 0.f);
-			//check neighbours with lowest cost
-			std::vector<sf::Vector2f> neighbours = getNeighbours(sf::Vector2f((float)x, (float)y));
-			for (int i = 0; i < neighbours.size(); ++i) {
-				int neighbourX = (int)neighbours[i].x;
-				int neighbourY = (int)neighbours[i].y;
-				int neighbourIndex = neighbourY * cols + neighbourX;
-				float value = m_integration[neighbourIndex];
-				//if its lower update direction
-				if (value < lowestCost) {
-
-					lowestCost = value;
-					//direction from current to neighbour and the next
-					sf::Vector2f current((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
-					sf::Vector2f next((neighbourX + 0.5f) * cellSize, (neighbourY + 0.5f) * cellSize);
-					bestDirection = MathUtils::normalize(next - current);
+	for (int index = 0; index < cols * rows; ++index)
+		updateDirection(index, neighbours);
+}
+
+void FlowField::updateDirection(int index, std::vector<sf::Vector2f>& neighbours)
+{
+	int x = index % cols;
+	int y = index / cols;
+	//set the lowest cost to current cell
+	float lowestCost = m_integration[index];
+
+	sf::Vector2f bestDirection(0.f, 0.f);
+	//check neighbours with lowest cost
+	getNeighbours(sf::Vector2f((float)x, (float)y), neighbours);
+	for (int i = 0; i < neighbours.size(); ++i) {
+		int neighbourX = (int)neighbours[i].x;
+		int neighbourY = (int)neighbours[i].y;
+		int neighbourIndex = neighbourY * cols + neighbourX;
+		float value = m_integration[neighbourIndex];
+		//if its lower update direction
+		if (value < lowestCost) {
+
+			lowestCost = value;
+			//direction from current to neighbour and the next
+			sf::Vector2f current((x + 0.5f) * cellSize, (y + 0.5f) * cellSize);
+			sf::Vector2f next((neighbourX + 0.5f) * cellSize, (neighbourY + 0.5f) * cellSize);
+			bestDirection = MathUtils::normalize(next - current);
+		}
+	}
+	m_directions[index] = bestDirection;
+}
+
+void FlowField::repairField(int changedIndex)
+{
+	sf::Clock clock;
+	m_pushes = 0;
+	m_relaxations = 0;
+	m_settled = 0;
+	m_changed.clear();
+	m_open.reset(cols * rows);
+	int goalIndex = cellGoalY * cols + cellGoalX;
+
+	std::vector<sf::Vector2f> neighbours;
+	std::vector<sf::Vector2f> around;
+
+	//the toggled cell changes its own cost and which of its neighbours can cut the corner past it
+	//so it and all 8 around it may see different neighbour costs
+	int changedX = changedIndex % cols;
+	int changedY = changedIndex / cols;
+	for (int y = std::max(changedY - 1, 0); y <= std::min(changedY + 1, rows - 1); ++y)
+		for (int x = std::max(changedX - 1, 0); x <= std::min(changedX + 1, cols - 1); ++x)
+			updateCell(y * cols + x, around);
+
+	//cheapest of integration and rhs first, like dijkstra
+	while (!m_open.empty())
+	{
+		int index = m_open.pop();
+		m_settled++;
+		m_changed.push_back(index);
+		float oldCost = m_integration[index];
+		bool cheaper = oldCost > m_rhs[index];
+		if (cheaper)
+		{
+			//got cheaper, its final like a settled cell in dijkstra
+			m_integration[index] = m_rhs[index];
+		}
+		else
+		{
+			//got dearer, forget it and let its neighbours give it a new cost, it comes back if it still has one
+			m_integration[index] = 999999.f;
+			updateCell(index, around);
+		}
+
+		sf::Vector2f cell(static_cast<float>(index % cols), static_cast<float>(index / cols));
+		getNeighbours(cell, neighbours);
+		for (auto& neighbour : neighbours)
+		{
+			int neighbourIndex = static_cast<int>(neighbour.y) * cols + static_cast<int>(neighbour.x);
+			if (neighbourIndex == goalIndex || m_costs[neighbourIndex] >= 9999.f)
+				continue;
+
+			sf::Vector2f offset = neighbour - cell;
+			float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
+			if (cheaper)
+			{
+				//a cheaper cell can only lower what its neighbours get
+				float newCost = m_integration[index] + m_costs[neighbourIndex] + euclideanDistance;
+				if (newCost < m_rhs[neighbourIndex])
+				{
+					m_rhs[neighbourIndex] = newCost;
+					m_relaxations++;
 				}
+				queueCell(neighbourIndex);
+			}
+			else if (m_rhs[neighbourIndex] == oldCost + m_costs[neighbourIndex] + euclideanDistance)
+			{
+				//only neighbours that got their cost through this cell have to look again
+				updateCell(neighbourIndex, around);
 			}
-			m_directions[index] = bestDirection;
 		}
+	}
+
+	//only the changed cells and the ones next to them can point somewhere else
+	m_redirect.clear();
+	m_redirectMarked.resize(cols * rows, false);
+	m_changed.push_back(changedIndex);
+	for (int index : m_changed)
+	{
+		int x = index % cols;
+		int y = index / cols;
+		for (int aroundY = std::max(y - 1, 0); aroundY <= std::min(y + 1, rows - 1); ++aroundY)
+			for (int aroundX = std::max(x - 1, 0); aroundX <= std::min(x + 1, cols - 1); ++aroundX)
+			{
+				int aroundIndex = aroundY * cols + aroundX;
+				if (!m_redirectMarked[aroundIndex])
+				{
+					m_redirectMarked[aroundIndex] = true;
+					m_redirect.push_back(aroundIndex);
+				}
+			}
+	}
+	for (int index : m_redirect)
+	{
+		updateDirection(index, neighbours);
+		updateCostText(index);
+		m_redirectMarked[index] = false;
+	}
+
+	std::cout << "Repaired: " << m_settled << " cells reprocessed, " << m_pushes << " pushes, "
+		<< clock.getElapsedTime().asMicroseconds() << " us\n";
+}
+
+void FlowField::updateCell(int index, std::vector<sf::Vector2f>& neighbours)
+{
+	int goalIndex = cellGoalY * cols + cellGoalX;
+	if (index != goalIndex)
+		m_rhs[index] = lowestNeighbourCost(index, neighbours);
+	queueCell(index);
+}
+
+void FlowField::queueCell(int index)
+{
+	//out of date cells go on the open list, up to date ones come off it
+	if (m_integration[index] != m_rhs[index])
+	{
+		if (m_open.pushOrUpdate(index, std::min(m_integration[index], m_rhs[index])))
+			m_pushes++;
+	}
+	else
+	{
+		m_open.remove(index);
+	}
+}
+
+float FlowField::lowestNeighbourCost(int index, std::vector<sf::Vector2f>& neighbours)
+{
+	//obstacles never get a cost, same as in the dijkstra pass
+	if (m_costs[index] >= 9999.f)
+		return 999999.f;
+
+	int goalIndex = cellGoalY * cols + cellGoalX;
+	sf::Vector2f cell(static_cast<float>(index % cols), static_cast<float>(index / cols));
+	float lowestCost = 999999.f;
+	getNeighbours(cell, neighbours);
+	for (auto& neighbour : neighbours)
+	{
+		int neighbourIndex = static_cast<int>(neighbour.y) * cols + static_cast<int>(neighbour.x);
+		//unreached cells and obstacles (apart from the goal) cant pass a cost on
+		if (m_integration[neighbourIndex] >= 999999.f || (m_costs[neighbourIndex] >= 9999.f && neighbourIndex != goalIndex))
+			continue;
+
+		//same sum as the dijkstra pass so the values come out exactly the same
+		sf::Vector2f offset = cell - neighbour;
+		float euclideanDistance = MathUtils::vectorLength(offset) * cellSize;
+		float newCost = m_integration[neighbourIndex] + m_costs[index] + euclideanDistance;
+		if (newCost < lowestCost)
+			lowestCost = newCost;
+	}
+	return lowestCost;
 }
 
 void FlowField::setStartPosition(sf::Vector2f position)
@@ -543,7 +706,7 @@ void FlowField::setGoalPosition(sf::Vector2f position)
 	m_goalCircle.setPosition(sf::Vector2f(goalCenterX, goalCenterY));
 	m_goal = m_goalCircle.getPosition();
 
-	makeIntegrationFieldBFS();   
+	makeIntegrationField();   
 	makeFlowField();        
 	updateCostTexts();        
 }
@@ -593,6 +756,17 @@ void FlowField::updateCostTexts()
 	}
 }
 
+void FlowField::updateCostText(int index)
+{
+	if (index >= (int)m_costTexts.size())
+		return;
+
+	if (m_costs[index] >= 9999.f)
+		m_costTexts[index].setString("X");
+	else
+		m_costTexts[index].setString(std::to_string((int)m_integration[index]));
+}
+
 void FlowField::setFont(sf::Font& font)
 {
 	m_font = &font;
@@ -622,7 +796,7 @@ bool FlowField::isUsingAStar()
 
 void FlowField::resetField()
 {
-	makeIntegrationFieldBFS();
+	makeIntegrationField();
 	makeFlowField();
 	updateCostTexts();
 	m_circle.setFillColor(sf::Color::Red);
@@ -4,6 +4,7 @@
 #include <SFML/Graphics/Text.hpp>
 #include "MathUtils.h"
 #include "UI.h"
+#include "IndexedHeap.h"
 
 
 class FlowField
@@ -37,13 +38,24 @@ private:
 	
 	void makeGrid();
 	sf::Vector2f getDirectionsAtPosition(sf::Vector2f position);
-	std::vector<sf::Vector2f> getNeighbours(sf::Vector2f cell);
+	//fills neighbours, the passes reuse one vector instead of making one per cell
+	void getNeighbours(sf::Vector2f cell, std::vector<sf::Vector2f>& neighbours);
 	float heuristic(sf::Vector2f from, sf::Vector2f to);
 	void makeCostsField();
-	void makeIntegrationFieldBFS();
+	void makeIntegrationField();
+	void makeIntegrationFieldDijkstra();
 	void makeIntegrationFieldAStar();
 	void makeFlowField();
+	void updateDirection(int index, std::vector<sf::Vector2f>& neighbours);
+	void updateCostText(int index);
 	void resetField();
+
+	//incremental repair after one cell is toggled (LPA* without a heuristic)
+	//only cells whose integration value changes are taken off the open list
+	void repairField(int changedIndex);
+	void updateCell(int index, std::vector<sf::Vector2f>& neighbours);
+	void queueCell(int index);
+	float lowestNeighbourCost(int index, std::vector<sf::Vector2f>& neighbours);
 	
 	
 
@@ -53,8 +65,21 @@ private:
 	sf::Vector2f m_goal;
 	std::vector<float> m_costs;
 	std::vector<float> m_integration;
+	//cost each cell would get from its neighbours now, equal to m_integration when the field is up to date
+	std::vector<float> m_rhs;
+	//cells whose integration value the last repair changed
+	std::vector<int> m_changed;
+	//cells the last repair has to point again, marked so each is only done once
+	std::vector<int> m_redirect;
+	std::vector<bool> m_redirectMarked;
 	std::vector<sf::Vector2f> m_directions;
 	std::vector<sf::Vector2f> m_path;
+	IndexedHeap m_open;
+
+	//counters for the last integration pass
+	int m_pushes = 0;      //cells added to the open list
+	int m_relaxations = 0; //times a cell got a cheaper cost
+	int m_settled = 0;     //cells taken off the open list, each one once
 
 	//floats
 	float cellSize = 21.6f;
@@ -83,21 +108,6 @@ private:
 	bool movementEnabled = false;
 	bool showHeatMap = false;
 	bool useAStar = false;
-	
-	struct Node {
-		sf::Vector2f cell;
-		float gCost;
-		float hCost;
-		float fCost;
-
-		Node(sf::Vector2f c, float g, float h)
-			: cell(c), gCost(g), hCost(h), fCost(g + h) {}
-
-		bool operator>(const Node& other) const {
-			return fCost > other.fCost;
-		}
-
-	};
 
 
 
@@ -0,0 +1,127 @@
+#include "IndexedHeap.h"
+
+void IndexedHeap::reset(int cellCount)
+{
+	for (int cell : m_heap)
+		m_positions[cell] = -1;
+	m_heap.clear();
+
+	if (static_cast<int>(m_positions.size()) != cellCount)
+	{
+		m_costs.resize(cellCount);
+		m_positions.assign(cellCount, -1);
+	}
+}
+
+bool IndexedHeap::empty() const
+{
+	return m_heap.empty();
+}
+
+bool IndexedHeap::pushOrDecrease(int cell, float cost)
+{
+	m_costs[cell] = cost;
+	int position = m_positions[cell];
+	bool added = position < 0;
+	if (added)
+	{
+		position = static_cast<int>(m_heap.size());
+		m_heap.push_back(cell);
+		m_positions[cell] = position;
+	}
+	//the cost only goes down so it can only move up
+	siftUp(position);
+	return added;
+}
+
+bool IndexedHeap::pushOrUpdate(int cell, float cost)
+{
+	int position = m_positions[cell];
+	if (position < 0 || cost < m_costs[cell])
+		return pushOrDecrease(cell, cost);
+
+	m_costs[cell] = cost;
+	siftDown(position);
+	return false;
+}
+
+void IndexedHeap::remove(int cell)
+{
+	int position = m_positions[cell];
+	if (position < 0)
+		return;
+	m_positions[cell] = -1;
+
+	//the last cell fills the hole and goes whichever way it has to
+	int last = m_heap.back();
+	m_heap.pop_back();
+	if (last != cell)
+	{
+		place(position, last);
+		siftUp(position);
+		siftDown(m_positions[last]);
+	}
+}
+
+int IndexedHeap::pop()
+{
+	int cheapest = m_heap[0];
+	m_positions[cheapest] = -1;
+
+	int last = m_heap.back();
+	m_heap.pop_back();
+	if (!m_heap.empty())
+	{
+		place(0, last);
+		siftDown(0);
+	}
+	return cheapest;
+}
+
+void IndexedHeap::siftUp(int position)
+{
+	int cell = m_heap[position];
+	float cost = m_costs[cell];
+	//moves parents down until the cell fits, then puts it in the hole
+	while (position > 0)
+	{
+		int parent = (position - 1) / 4;
+		if (m_costs[m_heap[parent]] <= cost)
+			break;
+		place(position, m_heap[parent]);
+		position = parent;
+	}
+	place(position, cell);
+}
+
+void IndexedHeap::siftDown(int position)
+{
+	int cell = m_heap[position];
+	float cost = m_costs[cell];
+	int size = static_cast<int>(m_heap.size());
+	while (true)
+	{
+		//cheapest of up to 4 children
+		int first = position * 4 + 1;
+		if (first >= size)
+			break;
+		int last = (first + 4 < size) ? first + 4 : size;
+		int best = first;
+		for (int child = first + 1; child < last; ++child)
+		{
+			if (m_costs[m_heap[child]] < m_costs[m_heap[best]])
+				best = child;
+		}
+		if (m_costs[m_heap[best]] >= cost)
+			break;
+		place(position, m_heap[best]);
+		position = best;
+	}
+	place(position, cell);
+}
+
+void IndexedHeap::place(int position, int cell)
+{
+	m_heap[position] = cell;
+	m_positions[cell] = position;
+}
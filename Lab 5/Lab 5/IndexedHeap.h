@@ -0,0 +1,33 @@
+#pragma once
+#include <vector>
+
+//min heap of cell indices ordered by a cost, for the integration passes
+//each cell is in it at most once, a cheaper cost moves the cell up (decrease key)
+//instead of pushing a second copy that has to be skipped later
+//4 children per node so its half as deep as a binary heap
+class IndexedHeap
+{
+public:
+	//empties the heap for a grid of cellCount cells, only the cells left in it are touched
+	//so its cheap between passes on the same grid
+	void reset(int cellCount);
+	bool empty() const;
+	//adds the cell, or lowers its cost if its already in
+	//returns true if it was added
+	bool pushOrDecrease(int cell, float cost);
+	//same but the cost can go up as well
+	bool pushOrUpdate(int cell, float cost);
+	//takes the cell out if its in
+	void remove(int cell);
+	//removes and returns the cheapest cell
+	int pop();
+
+private:
+	void siftUp(int position);
+	void siftDown(int position);
+	void place(int position, int cell);
+
+	std::vector<int> m_heap;      //cells in heap order
+	std::vector<float> m_costs;   //cost of each cell, by cell index
+	std::vector<int> m_positions; //where each cell is in m_heap, -1 if its not in it
+};
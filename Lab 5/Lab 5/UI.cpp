@@ -45,7 +45,7 @@ bool UI::loadFont(const std::string& fontPath)
 
 void UI::setPathfindingMode(bool useAStar)
 {
-    m_currentMode = useAStar ? "A* Pathfinding" : "BFS Pathfinding";
+    m_currentMode = useAStar ? "A* Pathfinding" : "Dijkstra Pathfinding";
 	m_modeText.setFont(m_font);
     m_modeText.setCharacterSize(18);
     m_modeText.setFillColor(sf::Color::Yellow);
@@ -59,7 +59,7 @@ void UI::setUpText()
 
     std::vector<std::string> instructions = {
         "Flow Field Pathfinding",
-		"A: Toggle Pathfinding Mode (BFS(on start)/A*)",
+		"A: Toggle Pathfinding Mode (Dijkstra(on start)/A*)",
         "Left Click: Set Red Circle (Agent)",
         "Right Click: Set Green Circle (Goal)",
         "Middle Click: Toggle Obstacle",
@@ -22,7 +22,7 @@ private:
 	std::vector<sf::Text> m_texts;
 	sf::Font m_font;
 	sf::Text m_modeText{ m_font };
-	std::string m_currentMode = "BFS";
+	std::string m_currentMode = "Dijkstra Pathfinding";
 
 	
 };
@@ -0,0 +1,33 @@
+#include "SearchBench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+/**
+ * @file EngineBench.cpp
+ * @brief Headless search benchmark, built without SFML.
+ *
+ * Usage:
+ *   engine_bench [bench] [depth]                 node count signature and nodes per second
+ *   engine_bench time [maxDepth] [hashMegabytes] time to each depth on every position
+ */
+
+int main(int argc, char* argv[])
+{
+	std::string command = (argc > 1) ? argv[1] : "bench";
+
+	if (command == "time")
+	{
+		int maxDepth = (argc > 2) ? std::atoi(argv[2]) : 7;
+		int hashMegabytes = (argc > 3) ? std::atoi(argv[3]) : 16;
+		SearchBench::runTimeToDepth(std::max(1, maxDepth), static_cast<std::size_t>(std::max(1, hashMegabytes)));
+		return EXIT_SUCCESS;
+	}
+	if (command == "bench")
+	{
+		int depth = (argc > 2) ? std::atoi(argv[2]) : SearchBench::BENCH_DEPTH;
+		SearchBench::runBench(std::max(1, depth));
+		return EXIT_SUCCESS;
+	}
+
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,19 @@
+#include "CommandLine.h"
+#include <cstdlib>
+#include <iostream>
+/**
+ * @file FourthProtocolCli.cpp
+ * @brief The game's headless commands (CommandLine.h) without the window, built without SFML.
+ *
+ * Usage: fourth_protocol_cli <command> [arguments...]
+ */
+
+int main(int argc, char* argv[])
+{
+	int exitCode = EXIT_SUCCESS;
+	if (CommandLine::dispatch(argc, argv, exitCode))
+		return exitCode;
+
+	std::cout << "Usage: fourth_protocol_cli <command> [arguments...], the commands are listed in CommandLine.h\n";
+	return EXIT_FAILURE;
+}
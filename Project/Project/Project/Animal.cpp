@@ -1,7 +1,7 @@
 /**
  * @file Animal.cpp
  * @brief Implements the Animal class which represents player game pieces,
- *        their textures, drawing, movement rules, and board interactions.
+ *        their textures, drawing, and board interactions.
  */
 
 #include "Animal.h"
@@ -22,36 +22,6 @@ Animal::Animal(Player owner, AnimalType type) : m_owner(owner), m_type(type)
 {
 }
 
-/**
- * @brief Copy constructor. Ensures sprite position and ownership are copied.
- * @param other The Animal to copy.
- */
-Animal::Animal(const Animal& other)
-{
-    m_owner = other.m_owner;
-    m_type = other.m_type;
-
-    m_sprite.setPosition(other.m_sprite.getPosition());
-}
-
-/**
- * @brief Assignment operator. Prevents texture issues when copying pieces.
- * @param other The Animal to assign from.
- * @return Reference to *this.
- */
-Animal& Animal::operator=(const Animal& other)
-{
-    if (this != &other)
-    {
-        m_owner = other.m_owner;
-        m_type = other.m_type;
-
-        initAnimalTexture(50);
-        m_sprite.setPosition(other.m_sprite.getPosition());
-    }
-    return *this;
-}
-
 /**
  * @brief Returns the type of this Animal as a string.
  * @return "Frog", "Snake", "Donkey", or "Empty".
@@ -108,6 +78,15 @@ void Animal::setPosition(const sf::Vector2f& position)
     m_sprite.setPosition(position);
 }
 
+/**
+ * @brief Gets the on screen position of the Animal's sprite.
+ * @return Current world position.
+ */
+sf::Vector2f Animal::getPosition() const
+{
+    return m_sprite.getPosition();
+}
+
 /**
  * @brief Loads texture, sets texture rect, origin, and scale based on cell size.
  * @param cellSize Size of a board cell, used for scaling.
@@ -130,12 +109,12 @@ void Animal::initAnimalTexture(float cellSize)
         return;
     }
 
-    if (!m_texture.loadFromFile(filename)) {
-        std::cout << "no texture loaded: " << filename << "\n";
+    // Decoded once per file, every piece of the same type shares it
+    m_texture = TextureCache::get(filename);
+    if (!m_texture)
         return;
-    }
 
-    sf::Vector2u texSize = m_texture.getSize();
+    sf::Vector2u texSize = m_texture->getSize();
     sf::Vector2i frameSize(texSize.x / 2, texSize.y);
 
     sf::IntRect textureRect;
@@ -149,7 +128,7 @@ void Animal::initAnimalTexture(float cellSize)
         textureRect = sf::IntRect({ 0, 0 }, frameSize);
     }
 
-    m_sprite = sf::Sprite(m_texture, textureRect);
+    m_sprite = sf::Sprite(*m_texture, textureRect);
 
     m_sprite.setOrigin(sf::Vector2f(frameSize.x / 2.f, frameSize.y / 2.f));
 
@@ -173,9 +152,9 @@ void Animal::draw(sf::RenderWindow& m_window)
  */
 void Animal::rescale(float cellSize)
 {
-    if (isEmpty()) return;
+    if (isEmpty() || !m_texture) return;
 
-    sf::Vector2u texSize = m_texture.getSize();
+    sf::Vector2u texSize = m_texture->getSize();
     sf::Vector2i frameSize(texSize.x / 2, texSize.y);
 
     sf::IntRect textureRect;
@@ -203,125 +182,19 @@ sf::FloatRect Animal::getBounds() const
 }
 
 /**
- * @brief Checks if a board coordinate is within valid range.
- */
-bool Animal::isValidPosition(int row, int col, int boardSize) const
-{
-    return row >= 0 && row < boardSize && col >= 0 && col < boardSize;
-}
-
-/**
- * @brief Returns a list of valid moves for the animal based on its type.
- * @param currentRow Current grid row.
- * @param currentCol Current grid column.
- * @param grid Pointer to full board of Animals.
- * @param boardSize Dimension of square board.
- * @return Vector of valid move coordinates.
- */
-std::vector<sf::Vector2i> Animal::getValidMoves(int currentRow, int currentCol,
-    const Animal* grid, int boardSize) const
-{
-    std::vector<sf::Vector2i> validMoves;
-
-    if (isEmpty())
-        return validMoves;
-
-    switch (m_type)
-    {
-    case AnimalType::Donkey:
-        addAdjacentMoves(currentRow, currentCol, grid, boardSize, validMoves, false);
-        break;
-
-    case AnimalType::Snake:
-        addAdjacentMoves(currentRow, currentCol, grid, boardSize, validMoves, true);
-        break;
-
-    case AnimalType::Frog:
-        addAdjacentMoves(currentRow, currentCol, grid, boardSize, validMoves, true);
-        addFrogJumpMoves(currentRow, currentCol, grid, boardSize, validMoves);
-        break;
-
-    default:
-        break;
-    }
-
-    return validMoves;
-}
-
-/**
- * @brief Adds all 1-step moves (cardinal & diagonal if allowed).
+ * @brief Changes the piece this Animal shows, reloading the texture only on a change.
+ * @param owner New owner.
+ * @param type New type.
+ * @param cellSize Board cell size used for scaling.
  */
-void Animal::addAdjacentMoves(int row, int col, const Animal* grid, int boardSize,
-    std::vector<sf::Vector2i>& moves, bool includeDiagonal) const
+void Animal::setPiece(Player owner, AnimalType type, float cellSize)
 {
-    const int cardinalDirs[4][2] = { {0, -1}, {0, 1}, {-1, -0}, {1, 0} };
-    const int diagonalDirs[4][2] = { {-1, -1}, {-1, 1}, {1, -1}, {1, 1} };
-
-    for (int i = 0; i < 4; ++i)
-    {
-        int newRow = row + cardinalDirs[i][0];
-        int newCol = col + cardinalDirs[i][1];
-
-        if (isValidPosition(newRow, newCol, boardSize) &&
-            grid[newRow * boardSize + newCol].isEmpty())
-        {
-            moves.push_back({ newRow, newCol });
-        }
-    }
-
-    if (includeDiagonal)
-    {
-        for (int i = 0; i < 4; ++i)
-        {
-            int newRow = row + diagonalDirs[i][0];
-            int newCol = col + diagonalDirs[i][1];
-
-            if (isValidPosition(newRow, newCol, boardSize) &&
-                grid[newRow * boardSize + newCol].isEmpty())
-            {
-                moves.push_back({ newRow, newCol });
-            }
-        }
-    }
-}
-
-/**
- * @brief Adds frog jump moves (jump over any piece and land on next empty tile).
- */
-void Animal::addFrogJumpMoves(int row, int col, const Animal* grid, int boardSize,
-    std::vector<sf::Vector2i>& moves) const
-{
-    const int directions[8][2] = {
-        {-1, 0}, {1, 0}, {0, -1}, {0, 1},
-        {-1, -1}, {-1, 1}, {1, -1}, {1, 1}
-    };
-
-    for (int i = 0; i < 8; ++i)
-    {
-        int dirRow = directions[i][0];
-        int dirCol = directions[i][1];
-
-        int checkRow = row + dirRow;
-        int checkCol = col + dirCol;
-
-        while (isValidPosition(checkRow, checkCol, boardSize))
-        {
-            if (!grid[checkRow * boardSize + checkCol].isEmpty())
-            {
-                int landRow = checkRow + dirRow;
-                int landCol = checkCol + dirCol;
-
-                if (isValidPosition(landRow, landCol, boardSize) &&
-                    grid[landRow * boardSize + landCol].isEmpty())
-                {
-                    moves.push_back({ landRow, landCol });
-                }
+    if (owner == m_owner && type == m_type)
+        return;
 
-                break;
-            }
+    m_owner = owner;
+    m_type = type;
 
-            checkRow += dirRow;
-            checkCol += dirCol;
-        }
-    }
+    if (!isEmpty())
+        initAnimalTexture(cellSize);
 }
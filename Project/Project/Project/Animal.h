@@ -2,33 +2,15 @@
 #include <string>
 #include <SFML/Graphics.hpp>
 #include <iostream>
-
-/**
- * @enum Player
- * @brief Represents which player owns a piece.
- */
-enum Player {
-    NoPlayer,
-    Player1,
-    Player2
-};
-
-/**
- * @enum AnimalType
- * @brief Represents the type of animal.
- */
-enum AnimalType {
-    NoType,
-    Frog,
-    Snake,
-    Donkey
-};
+#include "GameTypes.h"
+#include "TextureCache.h"
 
 /**
  * @class Animal
- * @brief Represents a single game piece placed on the board.
+ * @brief Draws a single game piece.
  *
- * Stores ownership, type, sprite, texture, and movement logic.
+ * Stores ownership, type, sprite and a handle to the shared texture. The game itself lives in the
+ * Boardstate held by Game; board Animals are only a view of it.
  */
 class Animal
 {
@@ -75,6 +57,12 @@ public:
      */
     void setPosition(const sf::Vector2f& position);
 
+    /**
+     * @brief Gets the on screen sprite position.
+     * @return Pixel coordinates of the sprite's centre.
+     */
+    sf::Vector2f getPosition() const;
+
     /**
      * @brief Loads the correct sprite texture and scales it to cellSize.
      * @param cellSize The board cell size for scaling.
@@ -100,48 +88,28 @@ public:
     sf::FloatRect getBounds() const;
 
     /**
-     * @brief Copy constructor.
+     * @brief Copy constructor. The copy shares the cached texture.
      */
-    Animal(const Animal& other);
+    Animal(const Animal& other) = default;
 
     /**
-     * @brief Copy assignment operator.
+     * @brief Copy assignment operator. Never reloads the texture.
      * @return Reference to this object.
      */
-    Animal& operator=(const Animal& other);
+    Animal& operator=(const Animal& other) = default;
 
     /**
-     * @brief Computes valid movement locations for this animal.
-     *
-     * @param currentRow Row of the piece.
-     * @param currentCol Column of the piece.
-     * @param grid Pointer to full board grid array.
-     * @param boardSize Size of board.
-     * @return A list of valid movement destination positions.
+     * @brief Shows a different piece (or none) without copying another Animal.
+     * The texture is only reloaded when the owner or type changes.
+     * @param owner New owner, NoPlayer for an empty cell.
+     * @param type New animal type.
+     * @param cellSize Board cell size for scaling.
      */
-    std::vector<sf::Vector2i> getValidMoves(int currentRow, int currentCol,
-        const Animal* grid, int boardSize) const;
+    void setPiece(Player owner, AnimalType type, float cellSize);
 
 private:
     Player m_owner;
     AnimalType m_type;
-    sf::Texture m_texture;
-    sf::Sprite m_sprite{ m_texture };
-
-    /**
-     * @brief Checks if a position is within board bounds.
-     */
-    bool isValidPosition(int row, int col, int boardSize) const;
-
-    /**
-     * @brief Adds adjacent moves (cardinal + optional diagonal).
-     */
-    void addAdjacentMoves(int row, int col, const Animal* grid, int boardSize,
-        std::vector<sf::Vector2i>& moves, bool includeDiagonal) const;
-
-    /**
-     * @brief Adds frog style multi tile jumping moves.
-     */
-    void addFrogJumpMoves(int row, int col, const Animal* grid, int boardSize,
-        std::vector<sf::Vector2i>& moves) const;
+    TextureCache::Handle m_texture;
+    sf::Sprite m_sprite{ TextureCache::placeholder() };
 };
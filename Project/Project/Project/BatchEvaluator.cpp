@@ -0,0 +1,310 @@
+#include "BatchEvaluator.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static const int CELLS = BOARD_SIZE * BOARD_SIZE;
+static_assert(CELLS <= 32, "BatchEvaluator packs a board into 32 bit masks");
+
+using Lines = LineTable<BOARD_SIZE, WIN_LENGTH>;
+
+/**
+ * @struct LineCells
+ * @brief Cell indices of every line, unpacked from the shared line masks so the
+ *        AVX2 path can add one bit plane per cell.
+ */
+struct LineCells {
+	int cells[Lines::COUNT][WIN_LENGTH]{};
+};
+
+static constexpr LineCells makeLineCells()
+{
+	LineCells table{};
+	for (int line = 0; line < Lines::COUNT; ++line)
+	{
+		int i = 0;
+		for (int cell = 0; cell < CELLS; ++cell)
+			if (LINES<BOARD_SIZE, WIN_LENGTH>.mask[line] & (std::uint64_t(1) << cell))
+				table.cells[line][i++] = cell;
+	}
+	return table;
+}
+
+static constexpr LineCells LINE_CELLS = makeLineCells();
+
+/**
+ * @brief Combines the counts the same way Gameplay::evaluateBoard does.
+ */
+static int scoreFromCounts(const BatchResult& result, const EvalWeights& weights)
+{
+	return result.threes[0] * weights.threat - result.threes[1] * weights.opponentThreat
+		+ result.twos[0] * weights.build - result.twos[1] * weights.opponentBuild
+		+ (result.material[0] - result.material[1]) * weights.material
+		+ (result.center[0] - result.center[1]) * weights.center;
+}
+
+/**
+ * @brief Packs a board into occupancy masks for the maximizing player and the opponent.
+ */
+void BatchEvaluator::pack(const Boardstate& state, Player maximizingPlayer, std::uint32_t& ownBits, std::uint32_t& opponentBits)
+{
+	ownBits = 0;
+	opponentBits = 0;
+
+	// No branches, as in Gameplay::packBoard: owners are close to random
+	for (int row = 0; row < BOARD_SIZE; ++row) {
+		for (int col = 0; col < BOARD_SIZE; ++col) {
+			Player owner = state.grid[row][col].owner;
+			int cell = row * BOARD_SIZE + col;
+
+			ownBits |= std::uint32_t(owner == maximizingPlayer) << cell;
+			opponentBits |= std::uint32_t(owner != maximizingPlayer && owner != Player::NoPlayer) << cell;
+		}
+	}
+}
+
+/**
+ * @brief Evaluates a batch, using AVX2 for every full block of LANES boards.
+ */
+void BatchEvaluator::evaluate(const Boardstate* states, int count, Player maximizingPlayer, BatchResult* results,
+	const EvalWeights& weights)
+{
+	int done = 0;
+
+#if defined(__AVX2__)
+	alignas(32) std::uint32_t ownBits[LANES];
+	alignas(32) std::uint32_t opponentBits[LANES];
+
+	for (; done + LANES <= count; done += LANES)
+	{
+		for (int lane = 0; lane < LANES; ++lane) {
+			pack(states[done + lane], maximizingPlayer, ownBits[lane], opponentBits[lane]);
+		}
+		evaluateBlock(ownBits, opponentBits, results + done, weights);
+	}
+#endif
+
+	evaluateScalar(states + done, count - done, maximizingPlayer, results + done, weights);
+}
+
+/**
+ * @brief Scalar path, also used for the tail of a batch.
+ */
+void BatchEvaluator::evaluateScalar(const Boardstate* states, int count, Player maximizingPlayer, BatchResult* results,
+	const EvalWeights& weights)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		std::uint32_t ownBits, opponentBits;
+		pack(states[i], maximizingPlayer, ownBits, opponentBits);
+		evaluatePacked(&ownBits, &opponentBits, 1, results + i, weights);
+	}
+}
+
+/**
+ * @brief Counts lines for packed boards one at a time. Like Gameplay::countOpenLines every
+ *        line adds its compare results instead of branching on them, the counts are close
+ *        to random from line to line so branches would mispredict constantly.
+ */
+void BatchEvaluator::evaluatePacked(const std::uint32_t* ownBits, const std::uint32_t* opponentBits, int count, BatchResult* results,
+	const EvalWeights& weights)
+{
+	const Lines& lines = LINES<BOARD_SIZE, WIN_LENGTH>;
+
+	for (int i = 0; i < count; ++i)
+	{
+		int threes[2] = { 0, 0 };
+		int twos[2] = { 0, 0 };
+		int wins[2] = { 0, 0 };
+
+		for (int line = 0; line < Lines::COUNT; ++line)
+		{
+			const int own = countBits(ownBits[i] & lines.mask[line]);
+			const int opponent = countBits(opponentBits[i] & lines.mask[line]);
+			const int ownOnly = opponent == 0;
+			const int opponentOnly = own == 0;
+
+			threes[0] += ownOnly & (own == WIN_LENGTH - 1);
+			threes[1] += opponentOnly & (opponent == WIN_LENGTH - 1);
+			twos[0] += ownOnly & (own == WIN_LENGTH - 2);
+			twos[1] += opponentOnly & (opponent == WIN_LENGTH - 2);
+			wins[0] |= own == WIN_LENGTH;
+			wins[1] |= opponent == WIN_LENGTH;
+		}
+
+		BatchResult& result = results[i];
+		result.threes[0] = static_cast<std::uint8_t>(threes[0]);
+		result.threes[1] = static_cast<std::uint8_t>(threes[1]);
+		result.twos[0] = static_cast<std::uint8_t>(twos[0]);
+		result.twos[1] = static_cast<std::uint8_t>(twos[1]);
+		result.winFlags = static_cast<std::uint8_t>(wins[0] | (wins[1] << 1));
+		result.material[0] = static_cast<std::uint8_t>(countBits(ownBits[i]));
+		result.material[1] = static_cast<std::uint8_t>(countBits(opponentBits[i]));
+		result.center[0] = static_cast<std::uint8_t>(countBits(ownBits[i] & lines.centerMask));
+		result.center[1] = static_cast<std::uint8_t>(countBits(opponentBits[i] & lines.centerMask));
+		result.score = scoreFromCounts(result, weights);
+	}
+}
+
+/**
+ * @brief AVX2 block: each 32 bit lane holds one board.
+ *
+ * The occupancy masks are split into one 0/1 plane per cell, then every line
+ * is the sum of WIN_LENGTH planes and compares against the piece counts give the totals.
+ */
+void BatchEvaluator::evaluateBlock(const std::uint32_t* ownBits, const std::uint32_t* opponentBits, BatchResult* results,
+	const EvalWeights& weights)
+{
+#if defined(__AVX2__)
+	const Lines& lines = LINES<BOARD_SIZE, WIN_LENGTH>;
+
+	const __m256i own = _mm256_load_si256(reinterpret_cast<const __m256i*>(ownBits));
+	const __m256i opponent = _mm256_load_si256(reinterpret_cast<const __m256i*>(opponentBits));
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i two = _mm256_set1_epi32(WIN_LENGTH - 2);
+	const __m256i three = _mm256_set1_epi32(WIN_LENGTH - 1);
+	const __m256i four = _mm256_set1_epi32(WIN_LENGTH);
+
+	__m256i ownCell[CELLS];
+	__m256i opponentCell[CELLS];
+	__m256i material[2] = { zero, zero };
+	__m256i center[2] = { zero, zero };
+
+	for (int cell = 0; cell < CELLS; ++cell)
+	{
+		const __m128i shift = _mm_cvtsi32_si128(cell);
+		ownCell[cell] = _mm256_and_si256(_mm256_srl_epi32(own, shift), one);
+		opponentCell[cell] = _mm256_and_si256(_mm256_srl_epi32(opponent, shift), one);
+
+		material[0] = _mm256_add_epi32(material[0], ownCell[cell]);
+		material[1] = _mm256_add_epi32(material[1], opponentCell[cell]);
+		if (lines.centerMask & (std::uint64_t(1) << cell)) {
+			center[0] = _mm256_add_epi32(center[0], ownCell[cell]);
+			center[1] = _mm256_add_epi32(center[1], opponentCell[cell]);
+		}
+	}
+
+	// Compares give -1 per matching lane, so subtracting them counts
+	__m256i threes[2] = { zero, zero };
+	__m256i twos[2] = { zero, zero };
+	__m256i wins[2] = { zero, zero };
+
+	for (int line = 0; line < Lines::COUNT; ++line)
+	{
+		const int* c = LINE_CELLS.cells[line];
+		__m256i ownCount = ownCell[c[0]];
+		__m256i opponentCount = opponentCell[c[0]];
+		for (int i = 1; i < WIN_LENGTH; ++i) {
+			ownCount = _mm256_add_epi32(ownCount, ownCell[c[i]]);
+			opponentCount = _mm256_add_epi32(opponentCount, opponentCell[c[i]]);
+		}
+
+		__m256i ownOnly = _mm256_cmpeq_epi32(opponentCount, zero);
+		__m256i opponentOnly = _mm256_cmpeq_epi32(ownCount, zero);
+
+		threes[0] = _mm256_sub_epi32(threes[0], _mm256_and_si256(ownOnly, _mm256_cmpeq_epi32(ownCount, three)));
+		threes[1] = _mm256_sub_epi32(threes[1], _mm256_and_si256(opponentOnly, _mm256_cmpeq_epi32(opponentCount, three)));
+		twos[0] = _mm256_sub_epi32(twos[0], _mm256_and_si256(ownOnly, _mm256_cmpeq_epi32(ownCount, two)));
+		twos[1] = _mm256_sub_epi32(twos[1], _mm256_and_si256(opponentOnly, _mm256_cmpeq_epi32(opponentCount, two)));
+		wins[0] = _mm256_or_si256(wins[0], _mm256_cmpeq_epi32(ownCount, four));
+		wins[1] = _mm256_or_si256(wins[1], _mm256_cmpeq_epi32(opponentCount, four));
+	}
+
+	__m256i score = _mm256_mullo_epi32(threes[0], _mm256_set1_epi32(weights.threat));
+	score = _mm256_sub_epi32(score, _mm256_mullo_epi32(threes[1], _mm256_set1_epi32(weights.opponentThreat)));
+	score = _mm256_add_epi32(score, _mm256_mullo_epi32(twos[0], _mm256_set1_epi32(weights.build)));
+	score = _mm256_sub_epi32(score, _mm256_mullo_epi32(twos[1], _mm256_set1_epi32(weights.opponentBuild)));
+	score = _mm256_add_epi32(score, _mm256_mullo_epi32(_mm256_sub_epi32(material[0], material[1]), _mm256_set1_epi32(weights.material)));
+	score = _mm256_add_epi32(score, _mm256_mullo_epi32(_mm256_sub_epi32(center[0], center[1]), _mm256_set1_epi32(weights.center)));
+
+	alignas(32) int out[9][LANES];
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[0]), score);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[1]), threes[0]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[2]), threes[1]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[3]), twos[0]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[4]), twos[1]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[5]), material[0]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[6]), material[1]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[7]), center[0]);
+	_mm256_store_si256(reinterpret_cast<__m256i*>(out[8]), center[1]);
+	int winMask = (_mm256_movemask_ps(_mm256_castsi256_ps(wins[0])))
+		| (_mm256_movemask_ps(_mm256_castsi256_ps(wins[1])) << LANES);
+
+	for (int lane = 0; lane < LANES; ++lane)
+	{
+		BatchResult& result = results[lane];
+		result.score = out[0][lane];
+		result.threes[0] = static_cast<std::uint8_t>(out[1][lane]);
+		result.threes[1] = static_cast<std::uint8_t>(out[2][lane]);
+		result.twos[0] = static_cast<std::uint8_t>(out[3][lane]);
+		result.twos[1] = static_cast<std::uint8_t>(out[4][lane]);
+		result.material[0] = static_cast<std::uint8_t>(out[5][lane]);
+		result.material[1] = static_cast<std::uint8_t>(out[6][lane]);
+		result.center[0] = static_cast<std::uint8_t>(out[7][lane]);
+		result.center[1] = static_cast<std::uint8_t>(out[8][lane]);
+		result.winFlags = static_cast<std::uint8_t>(((winMask >> lane) & 1) | (((winMask >> (lane + LANES)) & 1) << 1));
+	}
+#else
+	evaluatePacked(ownBits, opponentBits, LANES, results, weights);
+#endif
+}
+
+/**
+ * @brief Compares batch and scalar scores on random positions and times both.
+ */
+void BatchEvaluator::runBenchmark(int positions)
+{
+	std::mt19937 rng(99);
+	Gameplay rules;
+
+	// Random placements followed by a few random moves
+	std::vector<Boardstate> states;
+	states.reserve(positions);
+	while (static_cast<int>(states.size()) < positions)
+	{
+		Boardstate state = Gameplay::randomStartingPosition(rng);
+		int plies = static_cast<int>(rng() % 20);
+		for (int ply = 0; ply < plies; ++ply) {
+			std::vector<Move> moves = rules.generateMoves(state);
+			if (moves.empty()) break;
+			state = rules.makeMove(state, moves[rng() % moves.size()]);
+		}
+		states.push_back(state);
+	}
+
+	std::vector<BatchResult> results(positions);
+	const int repeats = 10;
+
+	auto start = std::chrono::steady_clock::now();
+	long long checksum = 0;
+	for (int r = 0; r < repeats; ++r)
+		for (const Boardstate& state : states)
+			checksum += rules.evaluateBoard(state, Player::Player1);
+	auto middle = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		evaluate(states.data(), positions, Player::Player1, results.data());
+	auto end = std::chrono::steady_clock::now();
+
+	int mismatches = 0;
+	for (int i = 0; i < positions; ++i) {
+		if (results[i].score != rules.evaluateBoard(states[i], Player::Player1))
+			mismatches++;
+	}
+
+	double total = static_cast<double>(positions) * repeats;
+	double scalarNs = std::chrono::duration<double, std::nano>(middle - start).count() / total;
+	double batchNs = std::chrono::duration<double, std::nano>(end - middle).count() / total;
+
+	std::cout << "evaluateBoard: " << scalarNs << " ns/position (checksum " << checksum << ")\n";
+	std::cout << "BatchEvaluator" <<
+#if defined(__AVX2__)
+		" (AVX2)"
+#else
+		" (scalar)"
+#endif
+		<< ": " << batchNs << " ns/position, " << mismatches << " mismatches in " << positions << " positions\n";
+}
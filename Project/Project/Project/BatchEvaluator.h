@@ -0,0 +1,79 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+/**
+ * @file BatchEvaluator.h
+ * @brief Evaluates many independent Boardstates at once, one board per SIMD lane.
+ */
+
+/**
+ * @struct BatchResult
+ * @brief Everything the batch pass computes for one board.
+ *
+ * Counts are indexed [0] = maximizing player, [1] = opponent.
+ */
+struct BatchResult {
+	int score;               ///< Same value Gameplay::evaluateBoard returns with the same weights
+	std::uint8_t threes[2];  ///< Lines one piece short of a win with the last cell empty
+	std::uint8_t twos[2];    ///< Lines two pieces short of a win with the rest empty
+	std::uint8_t material[2];///< Pieces on the board
+	std::uint8_t center[2];  ///< Pieces off the edge of the board
+	std::uint8_t winFlags;   ///< Bit 0: maximizing player has a full line, bit 1: opponent has
+};
+
+/**
+ * @class BatchEvaluator
+ * @brief Batch version of Gameplay::evaluateBoard.
+ *
+ * Boards are packed into two 32 bit occupancy masks (one per player) and split
+ * into one bit plane per cell, so every line is WIN_LENGTH vector adds for
+ * all lanes at once. With AVX2 a block is 8 boards per register; blocks of
+ * 16 and 32 just run more registers back to back. Without AVX2 the same
+ * masks are counted one board at a time.
+ */
+class BatchEvaluator
+{
+public:
+	static const int LANES = 8; ///< Boards per AVX2 register
+
+	/**
+	 * @brief Evaluates count boards from maximizingPlayer's point of view.
+	 * @param states Boards to evaluate.
+	 * @param count Number of boards, any value (tails use the scalar path).
+	 * @param maximizingPlayer Player the scores are for.
+	 * @param results Output, one entry per board.
+	 * @param weights Weights used for BatchResult::score.
+	 */
+	static void evaluate(const Boardstate* states, int count, Player maximizingPlayer, BatchResult* results,
+		const EvalWeights& weights = EvalWeights());
+
+	/**
+	 * @brief Same as evaluate() but always uses the scalar path.
+	 */
+	static void evaluateScalar(const Boardstate* states, int count, Player maximizingPlayer, BatchResult* results,
+		const EvalWeights& weights = EvalWeights());
+
+	/**
+	 * @brief Checks the batch scores against Gameplay::evaluateBoard on random
+	 *        positions and prints the time per position for both.
+	 */
+	static void runBenchmark(int positions);
+
+private:
+	/**
+	 * @brief Packs a board into one occupancy mask per side, bit (row * BOARD_SIZE + col).
+	 */
+	static void pack(const Boardstate& state, Player maximizingPlayer, std::uint32_t& ownBits, std::uint32_t& opponentBits);
+
+	/**
+	 * @brief Scalar evaluation of already packed boards.
+	 */
+	static void evaluatePacked(const std::uint32_t* ownBits, const std::uint32_t* opponentBits, int count, BatchResult* results,
+		const EvalWeights& weights);
+
+	/**
+	 * @brief AVX2 evaluation of one block of LANES packed boards.
+	 */
+	static void evaluateBlock(const std::uint32_t* ownBits, const std::uint32_t* opponentBits, BatchResult* results,
+		const EvalWeights& weights);
+};
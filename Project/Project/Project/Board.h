@@ -8,8 +8,6 @@
 #include "Animal.h"
 #include <vector>
 
-const int BOARD_SIZE = 5;
-
 /**
  * @class Board
  * @brief Handles drawing, sizing, and positioning of the game board grid.
@@ -0,0 +1,167 @@
+#include "CommandLine.h"
+#include "MonteCarloTree.h"
+#include "BatchEvaluator.h"
+#include "NeuralEvaluator.h"
+#include "SelfPlay.h"
+#include "EvalTuner.h"
+#include "GameRecord.h"
+#include "GameAnalysis.h"
+#include "PositionString.h"
+#include "EngineProtocol.h"
+#include "SearchBench.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+bool CommandLine::dispatch(int argc, char* argv[], int& exitCode)
+{
+	std::string command = (argc > 1) ? argv[1] : "";
+
+	if (command == "mcts-bench")
+	{
+		float seconds = (argc > 2) ? static_cast<float>(std::atof(argv[2])) : 2.0f;
+		int maxThreads = (argc > 3) ? std::atoi(argv[3]) : static_cast<int>(std::thread::hardware_concurrency());
+		MonteCarloTree::runThroughputBenchmark(seconds, std::max(1, maxThreads));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "mcts-match")
+	{
+		int games = (argc > 2) ? std::atoi(argv[2]) : 20;
+		float seconds = (argc > 3) ? static_cast<float>(std::atof(argv[3])) : 0.5f;
+		int threads = (argc > 4) ? std::atoi(argv[4]) : static_cast<int>(std::thread::hardware_concurrency());
+		MonteCarloTree::runStrengthMatch(games, seconds, std::max(1, threads));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "eval-bench")
+	{
+		int positions = (argc > 2) ? std::atoi(argv[2]) : 100000;
+		BatchEvaluator::runBenchmark(std::max(1, positions));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "nnue-bench")
+	{
+		int positions = (argc > 2) ? std::atoi(argv[2]) : 100000;
+		NeuralEvaluator::runBenchmark(std::max(1, positions));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "position-bench")
+	{
+		int positions = (argc > 2) ? std::atoi(argv[2]) : 1000000;
+		PositionString::runBenchmark(std::max(1, positions));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "bench")
+	{
+		int depth = (argc > 2) ? std::atoi(argv[2]) : SearchBench::BENCH_DEPTH;
+		SearchBench::runBench(std::max(1, depth));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "search-bench")
+	{
+		int maxDepth = (argc > 2) ? std::atoi(argv[2]) : 7;
+		int hashMegabytes = (argc > 3) ? std::atoi(argv[3]) : 16;
+		SearchBench::runTimeToDepth(std::max(1, maxDepth), static_cast<std::size_t>(std::max(1, hashMegabytes)));
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "selfplay")
+	{
+		SelfPlaySettings settings;
+		settings.games = (argc > 2) ? std::atoi(argv[2]) : 1000;
+		settings.depth = (argc > 3) ? std::atoi(argv[3]) : 2;
+		settings.threads = (argc > 4) ? std::atoi(argv[4]) : static_cast<int>(std::thread::hardware_concurrency());
+		if (argc > 5) settings.outputPrefix = argv[5];
+		if (argc > 6) settings.recordDirectory = argv[6];
+		SelfPlay::run(settings);
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "tune" && argc > 3)
+	{
+		std::vector<std::string> paths(argv + 3, argv + argc);
+		bool written = EvalTuner::run(argv[2], paths, 1000, static_cast<int>(std::thread::hardware_concurrency()));
+		exitCode = written ? EXIT_SUCCESS : EXIT_FAILURE;
+		return true;
+	}
+	if (command == "replay" && argc > 2)
+	{
+		GameRecord record;
+		if (!record.load(argv[2])) {
+			std::cout << "Cannot read game record " << argv[2] << "\n";
+			exitCode = EXIT_FAILURE;
+			return true;
+		}
+
+		GameReplay replay(record);
+		int ply = (argc > 3) ? std::atoi(argv[3]) : replay.getPlyCount();
+		Boardstate state = replay.seek(ply);
+
+		const GameRecordHeader& header = record.getHeader();
+		std::cout << header.plies << " plies (" << header.dropPlies << " drops), seed " << header.seed
+			<< ", winner " << static_cast<int>(header.winner) << (replay.isValid() ? "" : ", CORRUPT") << "\n";
+		std::cout << "Position after ply " << std::min(ply, replay.getPlyCount()) << ", Player "
+			<< static_cast<int>(state.currentPlayer) << " to move:\n";
+		std::cout << PositionString::toString(state, Hand::offBoard(state)) << "\n";
+
+		const char symbols[4] = { '.', 'F', 'S', 'D' };
+		for (int row = 0; row < BOARD_SIZE; ++row)
+		{
+			for (int col = 0; col < BOARD_SIZE; ++col)
+			{
+				const PieceState& piece = state.grid[row][col];
+				char symbol = symbols[piece.type];
+				// Player 2 in lower case
+				std::cout << static_cast<char>(piece.owner == Player::Player2 ? symbol + ('a' - 'A') : symbol) << ' ';
+			}
+			std::cout << "\n";
+		}
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "engine")
+	{
+		EngineProtocol engine(std::cin, std::cout);
+		engine.run();
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+	if (command == "analyse" && argc > 2)
+	{
+		AnalysisSettings settings;
+		settings.directory = argv[2];
+		settings.depth = (argc > 3) ? std::atoi(argv[3]) : 3;
+		settings.threads = (argc > 4) ? std::atoi(argv[4]) : static_cast<int>(std::thread::hardware_concurrency());
+		if (argc > 5) settings.blunderThreshold = std::atoi(argv[5]);
+		if (argc > 6) settings.outputPrefix = argv[6];
+		if (argc > 7) settings.timeMs = std::atoi(argv[7]);
+		exitCode = GameAnalysis::run(settings) >= 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+		return true;
+	}
+	if (command == "shard-stats")
+	{
+		std::vector<std::string> paths(argv + 2, argv + argc);
+		std::vector<std::unique_ptr<ShardReader>> readers;
+		std::vector<const TrainingRecord*> records = ShardReader::openShuffled(paths, readers, 1);
+
+		int results[3] = { 0, 0, 0 };
+		for (const TrainingRecord* record : records) {
+			results[record->result + 1]++;
+		}
+		std::cout << records.size() << " positions in " << readers.size() << " shards: "
+			<< results[2] << " won, " << results[1] << " drawn, " << results[0] << " lost by the side to move\n";
+		exitCode = EXIT_SUCCESS;
+		return true;
+	}
+
+	return false;
+}
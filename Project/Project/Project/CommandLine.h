@@ -0,0 +1,36 @@
+#pragma once
+/**
+ * @file CommandLine.h
+ * @brief The headless tools, run by name from the game or from fourth_protocol_cli.
+ */
+
+/**
+ * @class CommandLine
+ * @brief Runs the tool named by the first argument. Nothing here needs SFML, so the same
+ *        commands work from the game's executable and from a headless build.
+ *
+ * Commands:
+ *   mcts-bench [secondsPerRun] [maxThreads]
+ *   mcts-match [games] [secondsPerMove] [threads]
+ *   eval-bench [positions]
+ *   nnue-bench [positions]
+ *   position-bench [positions]
+ *   search-bench [maxDepth] [hashMegabytes]
+ *   bench [depth] (node count signature of the search, see SearchBench.h)
+ *   selfplay [games] [depth] [threads] [outputPrefix] [recordDirectory]
+ *   replay record.fpgr [ply]
+ *   engine (text protocol on stdin/stdout, see EngineProtocol.h)
+ *   analyse recordDirectory [depth] [threads] [blunderThreshold] [outputPrefix] [timeMs]
+ *   shard-stats shard.bin...
+ *   tune weights.txt shard.bin...
+ */
+class CommandLine
+{
+public:
+	/**
+	 * @brief Runs the command in argv[1], if there is one this knows.
+	 * @param exitCode Set to the process exit code when a command ran.
+	 * @return false if argv names no command, the caller carries on without one.
+	 */
+	static bool dispatch(int argc, char* argv[], int& exitCode);
+};
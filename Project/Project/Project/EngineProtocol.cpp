@@ -0,0 +1,379 @@
+#include "EngineProtocol.h"
+#include "PositionString.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+/// Longest line printed after pv.
+static const int MAX_PV_LENGTH = 16;
+
+/**
+ * @brief True if the player has pieces left to place, the search only plays board moves.
+ */
+static bool holdsPieces(const Hand& hand, Player player)
+{
+	return std::any_of(std::begin(hand.count[player]), std::end(hand.count[player]), [](std::uint8_t count) { return count > 0; });
+}
+
+EngineProtocol::EngineProtocol(std::istream& in, std::ostream& out) : m_in(in), m_out(out), m_table(16),
+	m_threads(1), m_moveTimeMs(1000), m_stop(false), m_helperNodes(0)
+{
+	m_position.clear(Player::Player1);
+	m_historyKeys.push_back(Gameplay::positionKey(m_position));
+}
+
+EngineProtocol::~EngineProtocol()
+{
+	stopSearch();
+}
+
+void EngineProtocol::run()
+{
+	std::string line;
+	while (std::getline(m_in, line))
+	{
+		if (!handle(line))
+			break;
+	}
+
+	stopSearch();
+}
+
+bool EngineProtocol::handle(const std::string& line)
+{
+	std::istringstream args(line);
+	std::string command;
+	if (!(args >> command))
+		return true;
+
+	if (command == "fpi")
+	{
+		send("id name Fourth Protocol");
+		send("option name Hash type spin default 16 min 1 max 4096");
+		send("option name Threads type spin default 1 min 1 max 256");
+		send("option name MoveTime type spin default 1000 min 1 max 3600000");
+		send("option name Skill type spin default 20 min 0 max 20");
+		send("fpiok");
+	}
+	else if (command == "isready") {
+		send("readyok");
+	}
+	else if (command == "setoption") {
+		stopSearch();
+		setOption(args);
+	}
+	else if (command == "newgame") {
+		stopSearch();
+		m_table.clear();
+	}
+	else if (command == "position") {
+		stopSearch();
+		setPosition(args);
+	}
+	else if (command == "go") {
+		stopSearch();
+		go(args);
+	}
+	else if (command == "stop") {
+		stopSearch();
+	}
+	else if (command == "quit") {
+		return false;
+	}
+	else {
+		send("info string unknown command " + command);
+	}
+
+	return true;
+}
+
+/**
+ * @brief Reads the board, the side to move and any moves played from there.
+ *        A malformed position leaves the current one in place.
+ */
+void EngineProtocol::setPosition(std::istream& args)
+{
+	std::string board, side, hand;
+	args >> board >> side >> hand;
+
+	Boardstate position;
+	Hand pieces;
+	if (!PositionString::parse(board + " " + side + " " + hand, position, pieces)) {
+		send("info string invalid position");
+		return;
+	}
+
+	// Board and hand together hold no more than a whole set
+	const Hand spare = Hand::offBoard(position);
+	for (int player = Player::Player1; player <= Player::Player2; ++player)
+	{
+		for (int type = AnimalType::Frog; type <= AnimalType::Donkey; ++type)
+		{
+			if (pieces.count[player][type] > spare.count[player][type]) {
+				send("info string invalid position");
+				return;
+			}
+		}
+	}
+
+	Gameplay rules;
+	std::vector<std::uint64_t> keys(1, Gameplay::positionKey(position));
+	std::string word;
+	if (args >> word && word == "moves")
+	{
+		MoveList legal;
+		while (args >> word)
+		{
+			if (holdsPieces(pieces, position.currentPlayer)) {
+				send("info string illegal move " + word + ", pieces left to place");
+				return;
+			}
+
+			Move move = PositionString::parseMove(word);
+			rules.generateMoves(position, legal);
+			bool isLegal = std::any_of(legal.begin(), legal.end(), [&move](const Move& other) {
+				return other.row1 == move.row1 && other.col1 == move.col1 && other.row2 == move.row2 && other.col2 == move.col2;
+			});
+			if (!isLegal) {
+				send("info string illegal move " + word);
+				return;
+			}
+			position = rules.makeMove(position, move);
+			keys.push_back(Gameplay::positionKey(position));
+		}
+	}
+
+	m_position = position;
+	m_hand = pieces;
+	m_historyKeys.swap(keys);
+}
+
+void EngineProtocol::setOption(std::istream& args)
+{
+	std::string word, name;
+	int value = 0;
+	if (!(args >> word >> name >> word >> value) || value < (name == "Skill" ? 0 : 1)) {
+		send("info string invalid option");
+		return;
+	}
+
+	if (name == "Hash") {
+		m_table.resize(static_cast<std::size_t>(value));
+	}
+	else if (name == "Threads") {
+		m_threads = value;
+	}
+	else if (name == "MoveTime") {
+		m_moveTimeMs = value;
+	}
+	else if (name == "Skill") {
+		m_skill.setLevel(value);
+	}
+	else {
+		send("info string unknown option " + name);
+	}
+}
+
+/**
+ * @brief Starts a search with the limits given, MoveTime if none.
+ */
+void EngineProtocol::go(std::istream& args)
+{
+	if (holdsPieces(m_hand, m_position.currentPlayer)) {
+		send("info string cannot search the placement phase, pieces left to place");
+		return;
+	}
+
+	SearchLimits limits;
+	int depth = MAX_SEARCH_DEPTH;
+	int moveTimeMs = 0;
+	bool infinite = false;
+	bool limited = false;
+
+	std::string word;
+	while (args >> word)
+	{
+		if (word == "infinite") {
+			infinite = true;
+			continue;
+		}
+
+		long long value = 0;
+		if (!(args >> value))
+			break;
+
+		if (word == "depth") depth = static_cast<int>(std::clamp(value, 1ll, static_cast<long long>(MAX_SEARCH_DEPTH)));
+		else if (word == "nodes") limits.nodes = static_cast<std::uint64_t>(std::max(value, 1ll));
+		else if (word == "movetime") moveTimeMs = static_cast<int>(std::max(value, 1ll));
+		limited = true;
+	}
+
+	if (!limited && !infinite) {
+		moveTimeMs = m_moveTimeMs;
+	}
+	if (moveTimeMs > 0) {
+		limits.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(moveTimeMs);
+	}
+
+	m_stop = false;
+	limits.stop = &m_stop;
+	m_searchThread = std::thread(&EngineProtocol::search, this, m_position, limits, depth, infinite);
+}
+
+void EngineProtocol::stopSearch()
+{
+	if (m_searchThread.joinable())
+	{
+		m_stop = true;
+		m_searchThread.join();
+	}
+}
+
+/**
+ * @brief Depth d here is d plies: chooseBestMove(d - 1) searches the root move plus d - 1 more.
+ *        An iteration cut short by a limit is thrown away, unless it is the first.
+ */
+void EngineProtocol::search(Boardstate position, SearchLimits limits, int maxDepth, bool infinite)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	Gameplay rules;
+	rules.setVerbose(false);
+	rules.setTranspositionTable(&m_table);
+	rules.setGameHistory(m_historyKeys);
+
+	if (m_skill.isEnabled()) {
+		searchSkill(rules, position, limits, infinite);
+		return;
+	}
+
+	// Helpers stop on the flag or the clock, the node limit is the main search's
+	m_helperNodes = 0;
+	std::vector<std::thread> helpers;
+	SearchLimits helperLimits = limits;
+	helperLimits.nodes = 0;
+	for (int thread = 1; thread < m_threads; ++thread) {
+		helpers.emplace_back(&EngineProtocol::helper, this, position, helperLimits, maxDepth, thread);
+	}
+
+	Move best;
+	std::uint64_t nodes = 0;
+	for (int depth = 1; depth <= maxDepth; ++depth)
+	{
+		if (limits.nodes != 0) {
+			if (nodes >= limits.nodes)
+				break;
+			SearchLimits remaining = limits;
+			remaining.nodes = limits.nodes - nodes;
+			rules.setSearchLimits(remaining);
+		}
+		else {
+			rules.setSearchLimits(limits);
+		}
+
+		Move move = rules.chooseBestMove(position, depth - 1);
+		nodes += rules.getNodesEvaluated();
+
+		if (rules.wasStopped()) {
+			if (!best.isValid()) best = move;
+			break;
+		}
+
+		best = move;
+		if (!best.isValid())
+			break;
+
+		long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+		std::uint64_t totalNodes = nodes + m_helperNodes;
+
+		std::ostringstream info;
+		info << "info depth " << depth << " score " << rules.getLastScore() << " nodes " << totalNodes
+			<< " nps " << totalNodes * 1000 / std::max(ms, 1ll) << " time " << ms
+			<< " hashfull " << m_table.getPermilleFull() << " pv";
+		for (const Move& pvMove : rules.getPrincipalVariation(position, best, std::min(depth, MAX_PV_LENGTH))) {
+			info << " " << PositionString::moveText(pvMove);
+		}
+		send(info.str());
+
+		// A won or lost position does not get any clearer deeper down
+		if (std::abs(rules.getLastScore()) >= UNLIMITED_POWER && !infinite)
+			break;
+	}
+
+	// Stopped before a single root move was searched: any legal move beats none
+	if (!best.isValid())
+	{
+		MoveList moves;
+		rules.generateMoves(position, moves);
+		if (!moves.empty()) best = moves[0];
+	}
+
+	// An infinite search only answers to stop, unless there is nothing to play
+	while (infinite && best.isValid() && !m_stop) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	m_stop = true;
+	for (std::thread& helper : helpers) {
+		helper.join();
+	}
+
+	send(std::string("bestmove ") + (best.isValid() ? PositionString::moveText(best) : "none"));
+}
+
+/**
+ * @brief One info line for the whole search, its depth is the level's and not the one reached.
+ */
+void EngineProtocol::searchSkill(Gameplay& rules, Boardstate position, SearchLimits limits, bool infinite)
+{
+	auto start = std::chrono::steady_clock::now();
+	Move best = m_skill.chooseMove(rules, position, limits);
+
+	if (!best.isValid())
+	{
+		MoveList moves;
+		rules.generateMoves(position, moves);
+		if (!moves.empty()) best = moves[0];
+	}
+
+	long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	std::ostringstream info;
+	info << "info skill " << m_skill.getLevel() << " nodes " << m_skill.getNodesSearched() << " time " << ms;
+	send(info.str());
+
+	while (infinite && best.isValid() && !m_stop) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	m_stop = true;
+
+	send(std::string("bestmove ") + (best.isValid() ? PositionString::moveText(best) : "none"));
+}
+
+/**
+ * @brief Odd helpers start a ply deeper, so the threads are not all on the same iteration.
+ */
+void EngineProtocol::helper(Boardstate position, SearchLimits limits, int maxDepth, int offset)
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+	rules.setTranspositionTable(&m_table);
+	rules.setGameHistory(m_historyKeys);
+	rules.setSearchLimits(limits);
+
+	for (int depth = 1 + offset % 2; depth <= maxDepth && !m_stop; ++depth)
+	{
+		rules.chooseBestMove(position, depth - 1);
+		m_helperNodes += rules.getNodesEvaluated();
+		if (rules.wasStopped())
+			break;
+	}
+}
+
+void EngineProtocol::send(const std::string& line)
+{
+	std::lock_guard<std::mutex> lock(m_outMutex);
+	m_out << line << std::endl;
+}
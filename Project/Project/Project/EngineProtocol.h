@@ -0,0 +1,107 @@
+#pragma once
+#include "Gameplay.h"
+#include "TranspositionTable.h"
+#include "PositionString.h"
+#include "SkillLevel.h"
+#include <atomic>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+/**
+ * @file EngineProtocol.h
+ * @brief Line-based text protocol that drives the engine from another process.
+ */
+
+/**
+ * @class EngineProtocol
+ * @brief Reads commands from a stream and answers on another, in the style of UCI.
+ *
+ * Commands, one per line:
+ *   fpi                                  names the engine, lists the options, ends with fpiok
+ *   isready                              answers readyok once the previous commands are done
+ *   setoption name <Hash|Threads|MoveTime|Skill> value <n>
+ *   newgame                              forgets the transposition table
+ *   position <board> <side> <hand> [moves m1 m2 ...]
+ *                                        a PositionString, then board moves like b2c3;
+ *                                        positions the moves pass through count as draws;
+ *                                        board and hand together hold at most a whole set
+ *   go [depth n] [nodes n] [movetime ms] [infinite]
+ *                                        only in the movement phase: with pieces left in
+ *                                        the hand of the side to move it answers an
+ *                                        info string and no bestmove
+ *   stop                                 ends the search, bestmove follows
+ *   quit
+ *
+ * The search runs on its own thread so stop is read while it thinks. After every
+ * finished depth it prints "info depth d score s nodes n nps n time ms hashfull n pv ...",
+ * at the end "bestmove m" ("bestmove none" without legal moves). The table lives as
+ * long as the process, so a game played through one engine keeps it warm between moves.
+ * Threads above 1 adds helper searches sharing the table (lazy SMP). Skill below 20
+ * plays a weaker move from a search of a fixed node budget on one thread (SkillLevel),
+ * go's depth and Threads are then ignored.
+ */
+class EngineProtocol
+{
+public:
+	EngineProtocol(std::istream& in, std::ostream& out);
+	~EngineProtocol();
+
+	/**
+	 * @brief Handles commands until quit or the end of the input.
+	 */
+	void run();
+
+private:
+	/**
+	 * @brief Handles one command line.
+	 * @return false on quit.
+	 */
+	bool handle(const std::string& line);
+
+	void setPosition(std::istream& args);
+	void setOption(std::istream& args);
+	void go(std::istream& args);
+
+	/**
+	 * @brief Stops a running search and waits for its bestmove.
+	 */
+	void stopSearch();
+
+	/**
+	 * @brief Iterative deepening on the main search thread, helpers alongside.
+	 */
+	void search(Boardstate position, SearchLimits limits, int maxDepth, bool infinite);
+
+	/**
+	 * @brief The search at a Skill below full strength, on the search thread.
+	 */
+	void searchSkill(Gameplay& rules, Boardstate position, SearchLimits limits, bool infinite);
+
+	/**
+	 * @brief Helper thread: deepens the same position into the shared table until stopped.
+	 */
+	void helper(Boardstate position, SearchLimits limits, int maxDepth, int offset);
+
+	/**
+	 * @brief Writes one line and flushes it, from any thread.
+	 */
+	void send(const std::string& line);
+
+	std::istream& m_in;
+	std::ostream& m_out;
+	std::mutex m_outMutex;
+
+	Boardstate m_position;
+	Hand m_hand; ///< Kept with the position, the search only plays board moves
+	std::vector<std::uint64_t> m_historyKeys; ///< Position and every position after a move, for repetitions
+	TranspositionTable m_table;
+	int m_threads;
+	int m_moveTimeMs;
+	SkillLevel m_skill;
+
+	std::thread m_searchThread;
+	std::atomic<bool> m_stop;
+	std::atomic<std::uint64_t> m_helperNodes;
+};
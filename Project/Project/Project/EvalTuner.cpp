@@ -0,0 +1,273 @@
+#include "EvalTuner.h"
+#include "BatchEvaluator.h"
+#include "TrainingData.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+/**
+ * @brief Win probability for an evaluation.
+ */
+static double sigmoid(double scale, double evaluation)
+{
+	return 1.0 / (1.0 + std::exp(-scale * evaluation / 400.0));
+}
+
+/**
+ * @brief Evaluation of a position for real-valued weights.
+ */
+static double evaluate(const TuningPosition& position, const double* weights)
+{
+	double evaluation = 0.0;
+	for (int i = 0; i < EvalWeights::COUNT; ++i) {
+		evaluation += position.features[i] * weights[i];
+	}
+	return evaluation;
+}
+
+/**
+ * @brief Runs job(first, last, thread) on every thread over an even split of count items.
+ */
+template<typename Job>
+static void parallelFor(int threads, std::size_t count, Job job)
+{
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < threads; ++thread)
+	{
+		std::size_t first = count * thread / threads;
+		std::size_t last = count * (thread + 1) / threads;
+		workers.emplace_back(job, first, last, thread);
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+EvalTuner::EvalTuner(int threads) : m_threads(std::max(1, threads)), m_scale(1.0)
+{
+}
+
+/**
+ * @brief Reads the shards and turns every position into term counts with the batch evaluator.
+ */
+std::size_t EvalTuner::loadCorpus(const std::vector<std::string>& shardPaths)
+{
+	std::vector<std::unique_ptr<ShardReader>> readers;
+	std::vector<const TrainingRecord*> records = ShardReader::openShuffled(shardPaths, readers, 1);
+
+	// The batch evaluator scores every board for one player, so group by side to move
+	const Player sides[2] = { Player::Player1, Player::Player2 };
+	std::size_t skipped = 0;
+
+	for (Player side : sides)
+	{
+		std::vector<Boardstate> states;
+		std::vector<float> targets;
+		for (const TrainingRecord* record : records)
+		{
+			if (static_cast<Player>(record->sideToMove) != side)
+				continue;
+
+			// The search already saw a forced result, the evaluation terms had no say in it
+			if (std::abs(record->score) >= UNLIMITED_POWER) {
+				skipped++;
+				continue;
+			}
+
+			states.push_back(record->toBoardstate());
+			targets.push_back((record->result + 1) * 0.5f);
+		}
+
+		std::vector<BatchResult> results(states.size());
+		BatchEvaluator::evaluate(states.data(), static_cast<int>(states.size()), side, results.data());
+
+		for (std::size_t i = 0; i < states.size(); ++i)
+		{
+			const BatchResult& result = results[i];
+			TuningPosition position;
+			position.features[0] = result.threes[0];
+			position.features[1] = -static_cast<float>(result.threes[1]);
+			position.features[2] = result.twos[0];
+			position.features[3] = -static_cast<float>(result.twos[1]);
+			position.features[4] = static_cast<float>(result.material[0] - result.material[1]);
+			position.features[5] = static_cast<float>(result.center[0] - result.center[1]);
+			position.target = targets[i];
+			m_positions.push_back(position);
+		}
+	}
+
+	std::cout << "Loaded " << m_positions.size() << " positions from " << readers.size() << " shards ("
+		<< skipped << " solved positions skipped)\n";
+	return m_positions.size();
+}
+
+/**
+ * @brief Mean squared error over the corpus for integer weights.
+ */
+double EvalTuner::computeError(const EvalWeights& weights) const
+{
+	double values[EvalWeights::COUNT];
+	for (int i = 0; i < EvalWeights::COUNT; ++i) {
+		values[i] = weights[i];
+	}
+
+	std::vector<double> partial(m_threads, 0.0);
+	parallelFor(m_threads, m_positions.size(), [&](std::size_t first, std::size_t last, int thread) {
+		double sum = 0.0;
+		for (std::size_t i = first; i < last; ++i) {
+			double error = m_positions[i].target - sigmoid(m_scale, evaluate(m_positions[i], values));
+			sum += error * error;
+		}
+		partial[thread] = sum;
+	});
+
+	double total = 0.0;
+	for (double sum : partial) total += sum;
+	return m_positions.empty() ? 0.0 : total / m_positions.size();
+}
+
+/**
+ * @brief Golden section search for K, the error is unimodal in K for fixed weights.
+ */
+double EvalTuner::fitScale(const EvalWeights& weights)
+{
+	const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+	double low = 0.01, high = 10.0;
+
+	for (int step = 0; step < 40; ++step)
+	{
+		double a = high - ratio * (high - low);
+		double b = low + ratio * (high - low);
+
+		m_scale = a;
+		double errorA = computeError(weights);
+		m_scale = b;
+		double errorB = computeError(weights);
+
+		if (errorA < errorB) high = b;
+		else low = a;
+	}
+
+	m_scale = (low + high) / 2.0;
+	return m_scale;
+}
+
+/**
+ * @brief d(error)/d(weight) = mean(-2 (target - s) s (1 - s) K / 400 * feature).
+ */
+double EvalTuner::computeGradient(const double* weights, double* gradient) const
+{
+	std::vector<double> partialError(m_threads, 0.0);
+	std::vector<double> partialGradient(m_threads * EvalWeights::COUNT, 0.0);
+
+	parallelFor(m_threads, m_positions.size(), [&](std::size_t first, std::size_t last, int thread) {
+		double error = 0.0;
+		double local[EvalWeights::COUNT] = {};
+		for (std::size_t i = first; i < last; ++i)
+		{
+			const TuningPosition& position = m_positions[i];
+			double s = sigmoid(m_scale, evaluate(position, weights));
+			double difference = position.target - s;
+			double slope = -2.0 * difference * s * (1.0 - s) * m_scale / 400.0;
+
+			error += difference * difference;
+			for (int w = 0; w < EvalWeights::COUNT; ++w) {
+				local[w] += slope * position.features[w];
+			}
+		}
+		partialError[thread] = error;
+		std::copy(local, local + EvalWeights::COUNT, partialGradient.begin() + thread * EvalWeights::COUNT);
+	});
+
+	double count = static_cast<double>(std::max<std::size_t>(1, m_positions.size()));
+	double error = 0.0;
+	std::fill(gradient, gradient + EvalWeights::COUNT, 0.0);
+	for (int thread = 0; thread < m_threads; ++thread)
+	{
+		error += partialError[thread];
+		for (int w = 0; w < EvalWeights::COUNT; ++w) {
+			gradient[w] += partialGradient[thread * EvalWeights::COUNT + w];
+		}
+	}
+	for (int w = 0; w < EvalWeights::COUNT; ++w) {
+		gradient[w] /= count;
+	}
+	return error / count;
+}
+
+/**
+ * @brief Adam steps on real-valued weights, rounded at the end.
+ */
+EvalWeights EvalTuner::tune(const EvalWeights& start, int iterations)
+{
+	// Adam settings, a step of about one evaluation point per iteration
+	const double learningRate = 1.0, beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+
+	double weights[EvalWeights::COUNT], gradient[EvalWeights::COUNT];
+	double momentum[EvalWeights::COUNT] = {}, velocity[EvalWeights::COUNT] = {};
+	for (int i = 0; i < EvalWeights::COUNT; ++i) {
+		weights[i] = start[i];
+	}
+
+	for (int iteration = 1; iteration <= iterations; ++iteration)
+	{
+		double error = computeGradient(weights, gradient);
+
+		for (int i = 0; i < EvalWeights::COUNT; ++i)
+		{
+			momentum[i] = beta1 * momentum[i] + (1.0 - beta1) * gradient[i];
+			velocity[i] = beta2 * velocity[i] + (1.0 - beta2) * gradient[i] * gradient[i];
+			double correctedMomentum = momentum[i] / (1.0 - std::pow(beta1, iteration));
+			double correctedVelocity = velocity[i] / (1.0 - std::pow(beta2, iteration));
+			weights[i] -= learningRate * correctedMomentum / (std::sqrt(correctedVelocity) + epsilon);
+		}
+
+		if (iteration % 100 == 0 || iteration == iterations) {
+			std::cout << "Iteration " << iteration << ": error " << error << "\n";
+		}
+	}
+
+	EvalWeights tuned;
+	for (int i = 0; i < EvalWeights::COUNT; ++i) {
+		tuned[i] = static_cast<int>(std::lround(weights[i]));
+	}
+	return tuned;
+}
+
+/**
+ * @brief Tuning tool entry point.
+ */
+bool EvalTuner::run(const std::string& outputPath, const std::vector<std::string>& shardPaths, int iterations, int threads)
+{
+	EvalTuner tuner(threads);
+	if (tuner.loadCorpus(shardPaths) == 0) {
+		std::cout << "No positions to tune on\n";
+		return false;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	EvalWeights initial;
+	double scale = tuner.fitScale(initial);
+	double initialError = tuner.computeError(initial);
+	std::cout << "K = " << scale << ", starting error " << initialError << "\n";
+
+	EvalWeights tuned = tuner.tune(initial, iterations);
+	double tunedError = tuner.computeError(tuned);
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Tuned error " << tunedError << " (was " << initialError << ") in " << seconds << "s\n";
+	for (int i = 0; i < EvalWeights::COUNT; ++i) {
+		std::cout << "  " << EvalWeights::name(i) << ": " << initial[i] << " -> " << tuned[i] << "\n";
+	}
+
+	if (!tuned.save(outputPath)) {
+		std::cout << "Error writing " << outputPath << "\n";
+		return false;
+	}
+	std::cout << "Wrote " << outputPath << "\n";
+	return true;
+}
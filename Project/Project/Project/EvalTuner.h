@@ -0,0 +1,78 @@
+#pragma once
+#include "Gameplay.h"
+#include <string>
+#include <vector>
+/**
+ * @file EvalTuner.h
+ * @brief Texel-style tuning of the evaluateBoard weights from self-play results.
+ */
+
+/**
+ * @struct TuningPosition
+ * @brief One corpus position reduced to its evaluation terms.
+ *
+ * evaluateBoard is linear in its weights, so a position only needs its term
+ * counts: the evaluation for any weights is the dot product with features.
+ */
+struct TuningPosition {
+	float features[EvalWeights::COUNT]; ///< Signed term counts, from the side to move
+	float target;                       ///< Game result for the side to move: 1 win, 0.5 draw, 0 loss
+};
+
+/**
+ * @class EvalTuner
+ * @brief Minimises the squared error between sigmoid(evaluation) and game results.
+ *
+ * The scaling constant K is fitted first with the starting weights, then the
+ * weights are optimised with gradient descent (Adam steps). Error and gradient
+ * are summed over the corpus by several threads.
+ */
+class EvalTuner
+{
+public:
+	/**
+	 * @param threads Threads used for every pass over the corpus.
+	 */
+	explicit EvalTuner(int threads);
+
+	/**
+	 * @brief Loads every record of the shards, skipping positions the search had already solved.
+	 * @return Number of positions loaded.
+	 */
+	std::size_t loadCorpus(const std::vector<std::string>& shardPaths);
+
+	/**
+	 * @brief Finds the K that gives the lowest error for weights and keeps it for tuning.
+	 * @return The fitted K.
+	 */
+	double fitScale(const EvalWeights& weights);
+
+	/**
+	 * @brief Mean squared error of sigmoid(K * eval / 400) against the results.
+	 */
+	double computeError(const EvalWeights& weights) const;
+
+	/**
+	 * @brief Runs gradient descent from start.
+	 * @param start Starting weights.
+	 * @param iterations Number of full-corpus gradient steps.
+	 * @return Weights rounded to integers.
+	 */
+	EvalWeights tune(const EvalWeights& start, int iterations);
+
+	/**
+	 * @brief Loads the corpus, tunes from the default weights and writes the result.
+	 * @return true if the weights file was written.
+	 */
+	static bool run(const std::string& outputPath, const std::vector<std::string>& shardPaths, int iterations, int threads);
+
+private:
+	/**
+	 * @brief Error and gradient for real-valued weights, summed over all threads.
+	 */
+	double computeGradient(const double* weights, double* gradient) const;
+
+	std::vector<TuningPosition> m_positions;
+	int m_threads;
+	double m_scale;
+};
@@ -1,7 +1,17 @@
 
 #include "Game.h"
+#include "TextureCache.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
 #include <iostream>
 #include <cmath>
+
+/// Best moves shaded in the move highlights.
+static const int HINT_LINES = 3;
+
+/// Deepest iteration an AI player on the clock searches to.
+static const int MAX_AI_DEPTH = 32;
 /**
  * @brief Constructs the Game object, loads fonts, initializes UI text,
  *        sets up menu buttons, creates starting pieces, and prepares the game window.
@@ -69,6 +79,12 @@ m_DELETEexitGame{ false } // when true game will exit
 	m_menuCredits.setPosition({ m_window.getSize().x / 2.f + 380.f, 180.f });
 
 	m_board.updateCellSize(m_window.getSize());
+	m_board.recalculateGrid(m_window);
+
+	m_state.clear(Player::Player1);
+	m_history.reserve(64);
+	m_history.push_back(m_state);
+	m_historyKeys.push_back(Gameplay::positionKey(m_state));
 
 	float cellSize = m_board.getCellSize();
 	// player 1 pieces
@@ -93,6 +109,37 @@ m_DELETEexitGame{ false } // when true game will exit
 		m_player1Pieces[i].initAnimalTexture(cellSize);
 		m_player2Pieces[i].initAnimalTexture(cellSize);
 	}
+	updateAnimals();
+
+	// The board and all pieces are drawn from one atlas in one call when it loads
+	if (!m_sprites.loadAtlas())
+	{
+		std::cout << "Sprite atlas unavailable, drawing pieces one by one.\n";
+	}
+
+	// Tuned evaluation weights replace the hand-picked ones when present
+	EvalWeights weights;
+	if (weights.load("ASSETS/WEIGHTS/eval_weights.txt"))
+	{
+		m_aiPlayer.setWeights(weights);
+		m_hintSearch.setWeights(weights);
+		std::cout << "Loaded tuned evaluation weights.\n";
+	}
+
+	// The AI uses the neural evaluation when a network trained for this board is present
+	if (m_network.loadWeights("ASSETS/NETWORK/fourth_protocol.nnue", BOARD_SIZE))
+	{
+		m_aiPlayer.setNeuralEvaluator(&m_network);
+		m_hintSearch.setNeuralEvaluator(&m_network);
+		std::cout << "Loaded neural evaluation network.\n";
+	}
+
+	m_hintSearch.setVerbose(false);
+	m_hintSearch.setTranspositionTable(&m_hintTable);
+	m_aiPlayer.setTranspositionTable(&m_aiTable);
+
+	// Every piece texture is in the cache now, later pieces only share it
+	m_startupTextureDecodes = TextureCache::getDecodeCount();
 
 	std::cout << "Game initialized. Player 1 starts in Placement phase.\n";
 	m_currentGameState = GameState::MainMenu;
@@ -118,7 +165,9 @@ Game::~Game()
 /**
  * @brief Main game loop running at 60 FPS.
  *
- * Handles event processing, updates, and rendering.
+ * Handles event processing, updates, and rendering. In render-on-demand mode a
+ * frame is only drawn when something changed, and while nothing can change on
+ * its own (a human is thinking, the game is over) the loop sleeps in waitEvent.
  */
 void Game::run()
 {
@@ -128,77 +177,136 @@ void Game::run()
 	sf::Time timePerFrame = sf::seconds(1.0f / fps); // 60 fps
 	while (m_window.isOpen())
 	{
-		processEvents(); // as many as possible
-		timeSinceLastUpdate += clock.restart();
-		while (timeSinceLastUpdate > timePerFrame)
+		if (m_renderOnDemand && !isAnimating())
+		{
+			// Only input can change anything, so block until there is some
+			if (const std::optional newEvent = m_window.waitEvent())
+			{
+				handleEvent(newEvent);
+			}
+			processEvents();
+			update(timePerFrame);
+
+			clock.restart();
+			timeSinceLastUpdate = sf::Time::Zero;
+		}
+		else
+		{
+			processEvents(); // as many as possible
+			timeSinceLastUpdate += clock.restart();
+			while (timeSinceLastUpdate > timePerFrame)
+			{
+				timeSinceLastUpdate -= timePerFrame;
+				processEvents();	  // at least 60 fps
+				update(timePerFrame); // 60 fps
+			}
+		}
+
+		if (!m_renderOnDemand || m_needsRedraw || m_sceneDirty)
+		{
+			sf::Clock renderClock;
+			render(); // as many as possible
+			m_renderTime = renderClock.getElapsedTime();
+			m_needsRedraw = false;
+		}
+		else if (isAnimating())
 		{
-			timeSinceLastUpdate -= timePerFrame;
-			processEvents();	  // at least 60 fps
-			update(timePerFrame); // 60 fps
+			// Nothing to draw yet, wait for the next update instead of spinning
+			sf::sleep(timePerFrame - timeSinceLastUpdate);
 		}
-		render(); // as many as possible
 	}
 }
 /**
- * @brief Polls and handles all events (mouse, keyboard, close, resize).
+ * @brief True while something changes without input: the menu animation or an AI player's turn.
+ */
+bool Game::isAnimating() const
+{
+	if (m_currentGameState == GameState::MainMenu)
+		return true;
+
+	bool aiToMove = (m_state.currentPlayer == Player::Player1 && m_player1IsAI) ||
+		(m_state.currentPlayer == Player::Player2 && m_player2IsAI);
+	if (aiToMove)
+		return m_currentGameState == GameState::Placement || m_currentGameState == GameState::Movement;
+
+	// A human's move hints are still being searched
+	return m_currentGameState == GameState::Movement &&
+		(m_hintSearch.isSearching() || m_hintKey != Gameplay::positionKey(m_state));
+}
+/**
+ * @brief Polls and handles all pending events.
+ */
+void Game::processEvents()
+{
+	while (const std::optional newEvent = m_window.pollEvent())
+	{
+		handleEvent(newEvent);
+	}
+}
+/**
+ * @brief Handles one event (mouse, keyboard, close, resize).
  *
  * Handles:
  * - Closing the window
  * - Key presses
  * - Resizing and view adjustment
  * - Mouse dragging, movement, releasing
+ *
+ * Every event except a plain mouse move asks for a new frame.
  */
-void Game::processEvents()
+void Game::handleEvent(const std::optional<sf::Event>& newEvent)
 {
+	if (!newEvent->is<sf::Event::MouseMoved>())
+	{
+		m_needsRedraw = true;
+	}
 
-	while (const std::optional newEvent = m_window.pollEvent())
+	if (newEvent->is<sf::Event::Closed>()) // close window message
 	{
-		if (newEvent->is<sf::Event::Closed>()) // close window message
-		{
-			m_DELETEexitGame = true;
-		}
+		m_DELETEexitGame = true;
+	}
 
-		if (newEvent->is<sf::Event::KeyPressed>()) // user pressed a key
-		{
-			processKeys(newEvent);
-		}
-		// Handle window resize
-		if (newEvent->is<sf::Event::Resized>())
-		{
-			const sf::Event::Resized *resizeEvent = newEvent->getIf<sf::Event::Resized>();
+	if (newEvent->is<sf::Event::KeyPressed>()) // user pressed a key
+	{
+		processKeys(newEvent);
+	}
+	// Handle window resize
+	if (newEvent->is<sf::Event::Resized>())
+	{
+		const sf::Event::Resized *resizeEvent = newEvent->getIf<sf::Event::Resized>();
 
-			// Update view to prevent stretching
-			sf::View view(sf::FloatRect({0.f, 0.f}, sf::Vector2f(resizeEvent->size)));
-			m_window.setView(view);
+		// Update view to prevent stretching
+		sf::View view(sf::FloatRect({0.f, 0.f}, sf::Vector2f(resizeEvent->size)));
+		m_window.setView(view);
 
-			// Rejigs the board and animals to new size
-			m_board.updateCellSize(resizeEvent->size);
-			updateAnimals();
-		}
+		// Rejigs the board and animals to new size
+		m_board.updateCellSize(resizeEvent->size);
+		m_board.recalculateGrid(m_window);
+		updateAnimals();
+	}
 
-		// Handle mouse clicks and movement for drag-and-drop
-		if (newEvent->is<sf::Event::MouseButtonPressed>())
-		{
-			const sf::Event::MouseButtonPressed *mouseEvent = newEvent->getIf<sf::Event::MouseButtonPressed>();
-			if (mouseEvent->button == sf::Mouse::Button::Left)
-			{
-				handleMousePress(sf::Vector2i(mouseEvent->position));
-			}
-		}
-		if (newEvent->is<sf::Event::MouseButtonReleased>())
+	// Handle mouse clicks and movement for drag-and-drop
+	if (newEvent->is<sf::Event::MouseButtonPressed>())
+	{
+		const sf::Event::MouseButtonPressed *mouseEvent = newEvent->getIf<sf::Event::MouseButtonPressed>();
+		if (mouseEvent->button == sf::Mouse::Button::Left)
 		{
-			const sf::Event::MouseButtonReleased *mouseEvent = newEvent->getIf<sf::Event::MouseButtonReleased>();
-			if (mouseEvent->button == sf::Mouse::Button::Left)
-			{
-				handleMouseRelease(sf::Vector2i(mouseEvent->position));
-			}
+			handleMousePress(sf::Vector2i(mouseEvent->position));
 		}
-		if (newEvent->is<sf::Event::MouseMoved>())
+	}
+	if (newEvent->is<sf::Event::MouseButtonReleased>())
+	{
+		const sf::Event::MouseButtonReleased *mouseEvent = newEvent->getIf<sf::Event::MouseButtonReleased>();
+		if (mouseEvent->button == sf::Mouse::Button::Left)
 		{
-			const sf::Event::MouseMoved *mouseEvent = newEvent->getIf<sf::Event::MouseMoved>();
-			handleMouseMoved(sf::Vector2i(mouseEvent->position));
+			handleMouseRelease(sf::Vector2i(mouseEvent->position));
 		}
 	}
+	if (newEvent->is<sf::Event::MouseMoved>())
+	{
+		const sf::Event::MouseMoved *mouseEvent = newEvent->getIf<sf::Event::MouseMoved>();
+		handleMouseMoved(sf::Vector2i(mouseEvent->position));
+	}
 }
 
 /**
@@ -243,6 +351,7 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 		{
 			m_player1IsAI = false;
 			m_player2IsAI = false;
+			beginRecording();
 			m_currentGameState = GameState::Placement;
 			return;
 		}
@@ -250,6 +359,7 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 		{
 			m_player1IsAI = false;
 			m_player2IsAI = true;
+			beginRecording();
 			m_currentGameState = GameState::Placement;
 			return;
 		}
@@ -257,6 +367,7 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 		{
 			m_player1IsAI = true;
 			m_player2IsAI = true;
+			beginRecording();
 			m_currentGameState = GameState::Placement;
 			return;
 		}
@@ -273,7 +384,7 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 		std::vector<Animal> *pieces = nullptr;
 
 		// Determine which player's pieces to check
-		if (m_currentPlayer == Player::Player1)
+		if (m_state.currentPlayer == Player::Player1)
 		{
 			pieces = &m_player1Pieces;
 			piecesPlaced = m_player1PiecesPlaced;
@@ -293,6 +404,7 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 				m_isDragging = true;
 				m_draggedPieceIndex = i;
 				m_draggedPiece = &(*pieces)[i];
+				m_sceneDirty = true;
 				break;
 			}
 		}
@@ -305,14 +417,14 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 		int col = gridPos.y;
 
 		std::cout << "Click at grid (" << col << "," << row << "), Current player: "
-			<< (m_currentPlayer == Player::Player1 ? "Player1" : "Player2") << "\n";
+			<< (m_state.currentPlayer == Player::Player1 ? "Player1" : "Player2") << "\n";
 
 		// Check if click is within board bounds
 		if (row < 0 || row >= BOARD_SIZE || col < 0 || col >= BOARD_SIZE)
 			return;
 
 		// Check if clicking on current player's piece
-		if (!m_grid[row][col].isEmpty() && m_grid[row][col].getOwner() == m_currentPlayer)
+		if (m_state.grid[row][col].owner == m_state.currentPlayer)
 		{
 			std::cout << "Cell has: " << m_grid[row][col].getName()
 				<< " owned by Player" << (m_grid[row][col].getOwner() == Player::Player1 ? "1" : "2") << "\n";
@@ -323,9 +435,10 @@ void Game::handleMousePress(sf::Vector2i mousePos)
 			m_selectedCell = {row, col};
 			m_originalCell = {row, col};
 			m_selectedPiece = &m_grid[row][col];
+			m_sceneDirty = true;
 
 			// Calculate valid moves for this piece
-			m_validMoves = m_selectedPiece->getValidMoves(row, col, &m_grid[0][0], BOARD_SIZE);
+			m_gameplay.getValidMovesForPiece(row, col, m_state, m_validMoves);
 
 			std::cout << "Selected " << m_selectedPiece->getName()
 					  << " at (" << col << ", " << row << ") with "
@@ -350,6 +463,7 @@ void Game::handleMouseMoved(sf::Vector2i mousePos)
 		if (m_isDragging && m_draggedPiece != nullptr)
 		{
 			m_draggedPiece->setPosition({static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)});
+			m_sceneDirty = true;
 		}
 	}
 	else if (m_currentGameState == GameState::Movement)
@@ -358,6 +472,7 @@ void Game::handleMouseMoved(sf::Vector2i mousePos)
 		if (m_isDragging && m_selectedPiece != nullptr)
 		{
 			m_selectedPiece->setPosition({static_cast<float>(mousePos.x), static_cast<float>(mousePos.y)});
+			m_sceneDirty = true;
 		}
 	}
 }
@@ -372,6 +487,9 @@ void Game::handleMouseMoved(sf::Vector2i mousePos)
  */
 void Game::handleMouseRelease(sf::Vector2i mousePos)
 {
+	// Whatever happens, the dragged piece lands somewhere new
+	m_sceneDirty = true;
+
 	if (m_currentGameState == GameState::Placement)
 	{
 		// PLACEMENT PHASE: Try to place piece on board
@@ -389,18 +507,13 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 		int row = static_cast<int>((mousePos.y - boardTop) / cellSize);
 
 		// Check if dropped on valid empty cell
-		if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE && m_grid[row][col].isEmpty())
+		if (row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE && m_state.grid[row][col].owner == Player::NoPlayer)
 		{
 			// Place the piece
-			Player owner = m_draggedPiece->getOwner();
-			AnimalType type = m_draggedPiece->getType();
-
-			m_grid[row][col] = Animal(owner, type);
-			m_grid[row][col].initAnimalTexture(m_board.getCellSize());
-			m_grid[row][col].setPosition(m_board.getCellCenter(row, col));
+			placePiece(row, col, m_draggedPiece->getOwner(), m_draggedPiece->getType());
 
 			// Remove from side list
-			if (m_currentPlayer == Player::Player1)
+			if (m_state.currentPlayer == Player::Player1)
 			{
 				m_player1Pieces.erase(m_player1Pieces.begin() + m_draggedPieceIndex);
 			}
@@ -413,10 +526,13 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 			m_draggedPiece = nullptr;
 			m_draggedPieceIndex = -1;
 
+			// Close the gap the piece left in the side list
+			updateAnimals();
+
 			// Check for win condition
 			if (checkWinCondition())
 			{
-				m_winner = m_currentPlayer;
+				m_winner = m_state.currentPlayer;
 				switchGameState(GameState::GameOver);
 				m_isDragging = false;
 				m_draggedPiece = nullptr;
@@ -427,7 +543,7 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 			// Check if all pieces are placed
 			if (m_player1Pieces.empty() && m_player2Pieces.empty())
 			{
-				m_currentPlayer = Player::Player1; // Reset to Player 1 for movement phase
+				endTurn(); // Player 2 placed last, so Player 1 starts the movement phase
 				switchGameState(GameState::Movement);
 				std::cout << "\n*** ALL PIECES PLACED! ***\n";
 				std::cout << "Entering Movement phase.\n";
@@ -439,10 +555,7 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 			}
 
 			// Switch player
-			if (m_currentPlayer == Player::Player1)
-				m_currentPlayer = Player::Player2;
-			else
-				m_currentPlayer = Player::Player1;
+			endTurn();
 		}
 		else
 		{
@@ -470,7 +583,7 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 		// Check if the target position is in the list of valid moves
 		for (const auto &move : m_validMoves)
 		{
-			if (move.x == targetRow && move.y == targetCol)
+			if (move.row2 == targetRow && move.col2 == targetCol)
 			{
 				validMove = true;
 				break;
@@ -483,17 +596,12 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 					  << ") to (" << targetRow << ", " << targetCol << ")\n";
 
 			// Move the piece
-			m_grid[targetRow][targetCol] = m_grid[m_originalCell.x][m_originalCell.y];
-			m_grid[targetRow][targetCol].initAnimalTexture(m_board.getCellSize());
-			m_grid[targetRow][targetCol].setPosition(m_board.getCellCenter(targetRow, targetCol));
-
-			// Clear the original cell
-			m_grid[m_originalCell.x][m_originalCell.y] = Animal();
+			applyMove({ m_originalCell.x, m_originalCell.y, targetRow, targetCol });
 
 			// Check for win condition
 			if (checkWinCondition())
 			{
-				m_winner = m_currentPlayer;
+				m_winner = m_state.currentPlayer;
 				switchGameState(GameState::GameOver);
 
 				// Reset selection state
@@ -505,8 +613,8 @@ void Game::handleMouseRelease(sf::Vector2i mousePos)
 			}
 
 			// Switch player
-			m_currentPlayer = (m_currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
-			std::cout << "Turn switched to Player " << (m_currentPlayer == Player::Player1 ? "1" : "2") << "\n";
+			endTurn();
+			std::cout << "Turn switched to Player " << (m_state.currentPlayer == Player::Player1 ? "1" : "2") << "\n";
 		}
 		else
 		{
@@ -580,15 +688,14 @@ void Game::update(sf::Time t_deltaTime)
 
 		// Apply the scale
 		m_menuCredits.setScale({ scale, scale });
+		m_needsRedraw = true;
 	} 
 
 	if (m_currentGameState == GameState::Placement)
 	{
-		updateAnimals();
-
 		//check is the current player is AI
-		if ((m_player1IsAI && m_currentPlayer == Player::Player1) ||
-			(m_player2IsAI && m_currentPlayer == Player::Player2))
+		if ((m_player1IsAI && m_state.currentPlayer == Player::Player1) ||
+			(m_player2IsAI && m_state.currentPlayer == Player::Player2))
 		{
 			// Collect all empty positions
 			std::vector<sf::Vector2i> emptyPositions;
@@ -596,7 +703,7 @@ void Game::update(sf::Time t_deltaTime)
 			{
 				for (int col = 0; col < BOARD_SIZE; col++)
 				{
-					if (m_grid[row][col].isEmpty())
+					if (m_state.grid[row][col].owner == Player::NoPlayer)
 					{
 						emptyPositions.push_back({ row, col });
 					}
@@ -604,7 +711,7 @@ void Game::update(sf::Time t_deltaTime)
 			}
 
 			// If there are empty positions and pieces to place
-			auto& pieces = (m_currentPlayer == Player::Player1)
+			auto& pieces = (m_state.currentPlayer == Player::Player1)
 				? m_player1Pieces : m_player2Pieces;
 
 			if (!emptyPositions.empty() && !pieces.empty())
@@ -615,26 +722,19 @@ void Game::update(sf::Time t_deltaTime)
 				int row = chosenPos.x;
 				int col = chosenPos.y;
 
-				// Get the piece info before removing it
-				Player owner = pieces.back().getOwner();
-				AnimalType type = pieces.back().getType();
-
-				// Create new piece in grid at randomly chosen position
-				m_grid[row][col] = Animal(owner, type);
-
-				// Initialize texture and position
-				m_grid[row][col].initAnimalTexture(m_board.getCellSize());
-				m_grid[row][col].setPosition(m_board.getCellCenter(row, col));
+				// Place the last piece of the hand at the randomly chosen position
+				placePiece(row, col, pieces.back().getOwner(), pieces.back().getType());
 
 				//removes from the list
 				pieces.pop_back();
+				updateAnimals();
 
 				// Check for win condition after placing piece
 				if (checkWinCondition())
 				{
-					m_winner = m_currentPlayer;
+					m_winner = m_state.currentPlayer;
 					switchGameState(GameState::GameOver);
-					std::cout << "Player " << (m_currentPlayer == Player::Player1 ? "1" : "2")
+					std::cout << "Player " << (m_state.currentPlayer == Player::Player1 ? "1" : "2")
 						<< " wins during placement phase!\n";
 					return;
 				}
@@ -642,7 +742,7 @@ void Game::update(sf::Time t_deltaTime)
 				// checks if the pieces are in place
 				if (m_player1Pieces.empty() && m_player2Pieces.empty())
 				{
-					m_currentPlayer = Player::Player1; // Reset to Player 1 for movement
+					endTurn(); // Player 2 placed last, so Player 1 starts the movement phase
 					switchGameState(GameState::Movement);
 					std::cout << "\n*** ALL PIECES PLACED! ***\n";
 					std::cout << "Entering Movement phase.\n";
@@ -651,8 +751,7 @@ void Game::update(sf::Time t_deltaTime)
 				}
 
 				// Switch to next player
-				m_currentPlayer = (m_currentPlayer == Player::Player1)
-					? Player::Player2 : Player::Player1;
+				endTurn();
 
 				return; // one placement per frame
 			}
@@ -662,24 +761,18 @@ void Game::update(sf::Time t_deltaTime)
 	// Handle AI turn during movement phase
 	if (m_currentGameState == GameState::Movement) {
 		// Check if the current player is AI 
-		bool currentPlayerIsAI = (m_currentPlayer == Player::Player1 && m_player1IsAI) ||
-			(m_currentPlayer == Player::Player2 && m_player2IsAI);
+		bool currentPlayerIsAI = (m_state.currentPlayer == Player::Player1 && m_player1IsAI) ||
+			(m_state.currentPlayer == Player::Player2 && m_player2IsAI);
+		if (!currentPlayerIsAI) {
+			updateHints(t_deltaTime);
+		}
+		else {
+			m_hintSearch.abortSearch();
+		}
+
 		//if the current player is AI and not dragging then handle AI turn
 		if (currentPlayerIsAI && !m_isDragging) {
-			static sf::Clock aiThinkTimer;
-			static bool aiStarted = false;
-
-			if (!aiStarted && aiThinkTimer.getElapsedTime().asSeconds() > 1.0f) {
-				aiStarted = true;
-				handleAITurn();
-				aiStarted = false;
-				aiThinkTimer.restart();
-			}
-
-			// Reset timer when player switches to AI
-			if (aiThinkTimer.getElapsedTime().asSeconds() < 0.1f) {
-				aiStarted = false;
-			}
+			handleAITurn(t_deltaTime);
 		}
 	}
 
@@ -714,16 +807,33 @@ void Game::drawValidMoveHighlights(sf::RenderWindow &window)
 	selectedHighlight.setPosition({selectedPos.x - cellSize / 2 + 2, selectedPos.y - cellSize / 2 + 2});
 	window.draw(selectedHighlight);
 
+	// The hints only count once their search is done and still for this position
+	const bool hintsReady = !m_hintSearch.isSearching() && m_hintKey == Gameplay::positionKey(m_state);
+
 	// Draw highlights for all valid moves
 	for (const auto &move : m_validMoves)
 	{
-		sf::CircleShape highlight(cellSize * 0.15f);
-		highlight.setFillColor(sf::Color(0, 255, 0, 150)); // Semi-transparent green
+		float radius = cellSize * 0.15f;
+		sf::Color fill(0, 255, 0, 150); // Semi-transparent green
+
+		// One of the best moves: bigger and more yellow the better it is, unless it loses anyway
+		auto hint = std::find_if(m_hints.begin(), m_hints.end(), [&move](const ScoredMove& line) {
+			return line.move.row1 == move.row1 && line.move.col1 == move.col1 && line.move.row2 == move.row2 && line.move.col2 == move.col2;
+		});
+		if (hintsReady && hint != m_hints.end() && hint->score > -UNLIMITED_POWER)
+		{
+			float strength = static_cast<float>(HINT_LINES - (hint - m_hints.begin())) / HINT_LINES;
+			radius *= 1.0f + 0.5f * strength;
+			fill = sf::Color(static_cast<std::uint8_t>(255 * strength), 255, 0, static_cast<std::uint8_t>(150 + 100 * strength));
+		}
+
+		sf::CircleShape highlight(radius);
+		highlight.setFillColor(fill);
 		highlight.setOutlineColor(sf::Color::Green);
 		highlight.setOutlineThickness(2.0f);
 
-		sf::Vector2f cellCenter = m_board.getCellCenter(move.x, move.y);
-		highlight.setOrigin({cellSize * 0.15f, cellSize * 0.15f});
+		sf::Vector2f cellCenter = m_board.getCellCenter(move.row2, move.col2);
+		highlight.setOrigin({radius, radius});
 		highlight.setPosition(cellCenter);
 
 		window.draw(highlight);
@@ -744,41 +854,60 @@ void Game::render()
 {
 	m_window.clear(BLACK);
 
-	m_board.draw(m_window);
-
-	// Draw valid move highlights during movement phase
-	if (m_currentGameState == GameState::Movement)
+	if (m_sprites.isLoaded())
 	{
-		drawValidMoveHighlights(m_window);
-	}
+		// Highlights sit inside the cells, so drawing them first leaves the grid lines on top
+		if (m_currentGameState == GameState::Movement)
+		{
+			drawValidMoveHighlights(m_window);
+		}
 
-	// Draw pieces on the board
-	for (int row = 0; row < BOARD_SIZE; ++row)
+		if (m_sceneDirty)
+		{
+			rebuildScene();
+			m_sceneDirty = false;
+		}
+		m_sprites.draw(m_window);
+	}
+	else
 	{
-		for (int col = 0; col < BOARD_SIZE; ++col)
+		m_sceneDirty = false;
+		m_board.draw(m_window);
+
+		// Draw valid move highlights during movement phase
+		if (m_currentGameState == GameState::Movement)
 		{
-			// Don't draw the piece we're currently dragging from its original position
-			if (m_isDragging && m_selectedCell.x == row && m_selectedCell.y == col)
-				continue;
+			drawValidMoveHighlights(m_window);
+		}
 
-			m_grid[row][col].draw(m_window);
+		// Draw pieces on the board
+		for (int row = 0; row < BOARD_SIZE; ++row)
+		{
+			for (int col = 0; col < BOARD_SIZE; ++col)
+			{
+				// Don't draw the piece we're currently dragging from its original position
+				if (m_isDragging && m_selectedCell.x == row && m_selectedCell.y == col)
+					continue;
+
+				m_grid[row][col].draw(m_window);
+			}
 		}
-	}
 
-	// Draw unplaced pieces during placement phase
-	if (m_currentGameState == GameState::Placement)
-	{
-		for (int i = 0; i < m_player1Pieces.size(); ++i)
-			m_player1Pieces[i].draw(m_window);
+		// Draw unplaced pieces during placement phase
+		if (m_currentGameState == GameState::Placement)
+		{
+			for (int i = 0; i < m_player1Pieces.size(); ++i)
+				m_player1Pieces[i].draw(m_window);
 
-		for (int i = 0; i < m_player2Pieces.size(); ++i)
-			m_player2Pieces[i].draw(m_window);
-	}
+			for (int i = 0; i < m_player2Pieces.size(); ++i)
+				m_player2Pieces[i].draw(m_window);
+		}
 
-	// Draw the dragged piece on top of everything else
-	if (m_isDragging && m_selectedPiece != nullptr)
-	{
-		m_selectedPiece->draw(m_window);
+		// Draw the dragged piece on top of everything else
+		if (m_isDragging && m_selectedPiece != nullptr)
+		{
+			m_selectedPiece->draw(m_window);
+		}
 	}
 
 	if (m_currentGameState == GameState::GameOver)
@@ -812,11 +941,54 @@ void Game::render()
 	}
 	m_window.display();
 }
+/**
+ * @brief Refills the sprite batch: grid, placed pieces, unplaced pieces, then the dragged piece on top.
+ */
+void Game::rebuildScene()
+{
+	float cellSize = m_board.getCellSize();
+
+	m_sprites.clear();
+	m_sprites.addGrid(m_board);
+
+	for (int row = 0; row < BOARD_SIZE; ++row)
+	{
+		for (int col = 0; col < BOARD_SIZE; ++col)
+		{
+			// The piece being dragged is added last, at the mouse
+			if (m_isDragging && m_selectedCell.x == row && m_selectedCell.y == col)
+				continue;
+
+			const PieceState& piece = m_state.grid[row][col];
+			m_sprites.addPiece(piece.owner, piece.type, m_board.getCellCenter(row, col), cellSize);
+		}
+	}
+
+	if (m_currentGameState == GameState::Placement)
+	{
+		for (const std::vector<Animal>* pieces : { &m_player1Pieces, &m_player2Pieces })
+		{
+			for (const Animal& animal : *pieces)
+			{
+				if (&animal != m_draggedPiece)
+					m_sprites.addPiece(animal.getOwner(), animal.getType(), animal.getPosition(), cellSize);
+			}
+		}
+	}
+
+	const Animal* dragged = (m_draggedPiece != nullptr) ? m_draggedPiece : m_selectedPiece;
+	if (m_isDragging && dragged != nullptr)
+	{
+		m_sprites.addPiece(dragged->getOwner(), dragged->getType(), dragged->getPosition(), cellSize);
+	}
+}
 /**
  * @brief Rescales and repositions all pieces when the board or window is resized.
  */
 void Game::updateAnimals()
 {
+	m_sceneDirty = true;
+
 	float cellSize = m_board.getCellSize();
 	float boardLeft = (m_window.getSize().x - m_board.getSize() * cellSize) / 2.f;
 	float boardTop = (m_window.getSize().y - m_board.getSize() * cellSize) / 2.f;
@@ -856,87 +1028,114 @@ void Game::updateAnimals()
 }
 /**
  * @brief Checks all win conditions (horizontal, vertical, diagonal).
- * @return true if the current player has 4 in a row.
+ * @return true if the current player has WIN_LENGTH in a row.
  */
 bool Game::checkWinCondition()
 {
-	// Loop through the whole board
-	for (int row = 0; row < BOARD_SIZE; ++row)
-	{
-		for (int col = 0; col < BOARD_SIZE; ++col)
-		{
-			// Horizontal check
-			for (int row = 0; row < BOARD_SIZE; ++row)
-			{
-				for (int col = 0; col <= BOARD_SIZE - 4; ++col)
-				{
-					int count = 0;
-					for (int i = 0; i < 4; ++i)
-					{
-						if (!m_grid[row][col + i].isEmpty() &&
-							m_grid[row][col + i].getOwner() == m_currentPlayer)
-							count++;
-					}
-					if (count == 4)
-						return true;
-				}
-			}
+	Player winner;
+	return m_gameplay.checkWimCondition(m_state, winner) && winner == m_state.currentPlayer;
+}
+/**
+ * @brief Checks for a repeated position or an over-long movement phase.
+ * @return true if the game is drawn.
+ */
+bool Game::checkDrawCondition()
+{
+	int movementPlies = m_record.getPlyCount() - m_record.getHeader().dropPlies;
+	return m_drawRules.isDraw(m_historyKeys, movementPlies);
+}
+/**
+ * @brief Puts a piece from a player's hand on an empty cell.
+ * @param row Target row.
+ * @param col Target column.
+ * @param owner Player placing the piece.
+ * @param type Animal being placed.
+ */
+void Game::placePiece(int row, int col, Player owner, AnimalType type)
+{
+	m_state.grid[row][col] = { owner, type };
+	m_record.addDrop(row, col, type);
 
-			// Vertical check
-			for (int col = 0; col < BOARD_SIZE; ++col)
-			{
-				for (int row = 0; row <= BOARD_SIZE - 4; ++row)
-				{
-					int count = 0;
-					for (int i = 0; i < 4; ++i)
-					{
-						if (!m_grid[row + i][col].isEmpty() &&
-							m_grid[row + i][col].getOwner() == m_currentPlayer)
-							count++;
-					}
-					if (count == 4)
-						return true;
-				}
-			}
+	syncCell(row, col);
+}
+/**
+ * @brief Moves a piece on the board. The caller runs the win check, then endTurn.
+ * @param move Move from the rules.
+ */
+void Game::applyMove(const Move& move)
+{
+	m_state.grid[move.row2][move.col2] = m_state.grid[move.row1][move.col1];
+	m_state.grid[move.row1][move.col1] = { Player::NoPlayer, AnimalType::NoType };
+	m_record.addMove(move);
 
-			// For diagonal checks, only two directions are needed,
-			// Since the inverse of these will be covered by those two checks
-			// Checks all possible diagonal win conditions starting at the top-left tile
-			for (int startRow = 0; startRow <= BOARD_SIZE - 4; ++startRow)
-			{
-				for (int startCol = 0; startCol <= BOARD_SIZE - 4; ++startCol)
-				{
-					int count = 0;
-					for (int i = 0; i < 4; ++i)
-					{
-						if (!m_grid[startRow + i][startCol + i].isEmpty() &&
-							m_grid[startRow + i][startCol + i].getOwner() == m_currentPlayer)
-							count++;
-					}
-					if (count == 4)
-						return true;
-				}
-			}
+	syncCell(move.row1, move.col1);
+	syncCell(move.row2, move.col2);
+}
+/**
+ * @brief Seeds the game's random numbers and starts a new game record.
+ */
+void Game::beginRecording()
+{
+	std::uint32_t seed = static_cast<std::uint32_t>(std::time(nullptr));
+	std::srand(seed);
+	m_aiPlayer.setSeed(seed);
+	// On the clock the depth is not known until the AI has moved, handleAITurn raises it
+	m_record.begin(seed, m_player1IsAI, m_player2IsAI, m_timeManager.isEnabled() ? 0 : m_aiDepth);
+}
+/**
+ * @brief Writes the finished game to RECORDS/game-<seed>.fpgr, or game-<seed>-2.fpgr and so
+ *        on if a game started in the same second has already been saved.
+ */
+void Game::saveRecording()
+{
+	m_record.setWinner(m_winner);
 
-			// Checks all possible diagonal win conditions starting at the bottom-left tile
-			for (int startRow = 3; startRow < BOARD_SIZE; ++startRow)
-			{
-				for (int startCol = 0; startCol <= BOARD_SIZE - 4; ++startCol)
-				{
-					int count = 0;
-					for (int i = 0; i < 4; ++i)
-					{
-						if (!m_grid[startRow - i][startCol + i].isEmpty() &&
-							m_grid[startRow - i][startCol + i].getOwner() == m_currentPlayer)
-							count++;
-					}
-					if (count == 4)
-						return true;
-				}
-			}
-		}
+	std::error_code error;
+	std::filesystem::create_directories("RECORDS", error);
+
+	const std::string name = "RECORDS/game-" + std::to_string(m_record.getHeader().seed);
+	std::string path = name + ".fpgr";
+	for (int copy = 2; std::filesystem::exists(path, error); ++copy) {
+		path = name + "-" + std::to_string(copy) + ".fpgr";
+	}
+	if (m_record.save(path))
+	{
+		std::cout << "Game record saved to " << path << " (" << m_record.getPlyCount() << " plies)\n";
+	}
+	else
+	{
+		std::cout << "Error writing game record " << path << "\n";
 	}
-	return false;
+}
+/**
+ * @brief Passes the turn to the other player, records the new position and
+ *        ends a movement phase that has become a draw.
+ */
+void Game::endTurn()
+{
+	m_state.currentPlayer = (m_state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+	m_history.push_back(m_state);
+	m_historyKeys.push_back(Gameplay::positionKey(m_state));
+
+	if (m_currentGameState == GameState::Movement && checkDrawCondition())
+	{
+		std::cout << "Draw after " << m_history.size() - 1 << " turns.\n";
+		m_winner = Player::NoPlayer;
+		switchGameState(GameState::GameOver);
+	}
+}
+/**
+ * @brief Makes the Animal drawn at (row, col) match m_state.
+ * @param row Cell row.
+ * @param col Cell column.
+ */
+void Game::syncCell(int row, int col)
+{
+	const PieceState& piece = m_state.grid[row][col];
+
+	m_grid[row][col].setPiece(piece.owner, piece.type, m_board.getCellSize());
+	m_grid[row][col].setPosition(m_board.getCellCenter(row, col));
+	m_sceneDirty = true;
 }
 /**
  * @brief Switches the active game state and updates UI text for GameOver.
@@ -945,10 +1144,14 @@ bool Game::checkWinCondition()
 void Game::switchGameState(GameState newState)
 {
 	m_currentGameState = newState;
+	m_sceneDirty = true;
 
 	if (newState == GameState::GameOver)
 	{
 		std::string winText = (m_winner == Player::Player1) ? "Player 1 Wins!" : "Player 2 Wins!";
+		if (m_winner == Player::NoPlayer) {
+			winText = "Draw!";
+		}
 		m_winMessage.setString(winText);
 
 		// Center the text above the board
@@ -962,6 +1165,11 @@ void Game::switchGameState(GameState newState)
 		sf::FloatRect textBounds2 = m_winMessage2.getLocalBounds();
 		m_winMessage2.setOrigin({ textBounds2.size.x / 2.f, textBounds2.size.y / 2.f });
 		m_winMessage2.setPosition({ m_window.getSize().x / 2.f, m_window.getSize().y - 150.f });
+
+		std::cout << "Texture decodes since startup: "
+			<< TextureCache::getDecodeCount() - m_startupTextureDecodes << "\n";
+
+		saveRecording();
 	}
 }
 /**
@@ -999,12 +1207,26 @@ void Game::setupButtons(MenuButton* btn, sf::Font& font, const std::string& text
  */
 void Game::resetGame()
 {
+	m_aiPlayer.abortSearch();
+	m_aiThinking = false;
+	m_aiTable.clear();
+	m_timeManager.reset();
+	m_hintSearch.abortSearch();
+	m_hintTable.clear();
+	m_hints.clear();
+	m_hintKey = 0;
+
 	// Clear the board
+	m_state.clear(Player::Player1);
+	m_history.clear();
+	m_history.push_back(m_state);
+	m_historyKeys.clear();
+	m_historyKeys.push_back(Gameplay::positionKey(m_state));
 	for (int row = 0; row < BOARD_SIZE; row++)
 	{
 		for (int col = 0; col < BOARD_SIZE; col++)
 		{
-			m_grid[row][col] = Animal();
+			syncCell(row, col);
 		}
 	}
 
@@ -1034,9 +1256,9 @@ void Game::resetGame()
 		m_player1Pieces[i].initAnimalTexture(cellSize);
 		m_player2Pieces[i].initAnimalTexture(cellSize);
 	}
+	updateAnimals();
 
 	// Reset game state variables
-	m_currentPlayer = Player::Player1;
 	m_winner = Player::NoPlayer;
 	m_isDragging = false;
 	m_draggedPieceIndex = -1;
@@ -1052,28 +1274,150 @@ void Game::resetGame()
 
 	std::cout << "Game reset. Returning to main menu.\n";
 }
+/**
+ * @brief Searches in whatever the frame has left after drawing, so the window keeps its
+ *        frame rate on a single core. A slow frame still gets Gameplay::MIN_SLICE_NODES nodes.
+ */
+std::chrono::steady_clock::time_point Game::sliceDeadline(sf::Time t_frame) const
+{
+	const sf::Time margin = sf::milliseconds(2);
+	const sf::Time slice = std::max(t_frame - m_renderTime - margin, sf::milliseconds(1));
+	return std::chrono::steady_clock::now() + std::chrono::microseconds(slice.asMicroseconds());
+}
+/**
+ * @brief Starts a new multi-PV search whenever the position changes and runs it a slice
+ *        at a time, so selecting a piece never waits for it.
+ */
+void Game::updateHints(sf::Time t_frame)
+{
+	std::uint64_t key = Gameplay::positionKey(m_state);
+	if (key != m_hintKey)
+	{
+		m_hints.clear();
+		m_hintKey = key;
+		m_hintTable.clear();
+		m_hintSearch.setGameHistory(m_historyKeys);
+		m_hintSearch.beginSearch(m_state, m_aiDepth, HINT_LINES);
+	}
+
+	if (m_hintSearch.isSearching() && m_hintSearch.continueSearch(0, sliceDeadline(t_frame)))
+	{
+		m_hints = m_hintSearch.getSearchLines();
+		m_needsRedraw = true;
+	}
+}
+/**
+ * @brief Without a clock this is one search to m_aiDepth, with one the search deepens
+ *        from a single ply and the time manager decides when to stop.
+ */
+bool Game::beginAIMove()
+{
+	std::cout << "AI ("
+		<< (m_state.currentPlayer == Player::Player1 ? "P1" : "P2")
+		<< ") is thinking...\n";
+
+	m_aiBestMove = Move();
+	m_aiPlayer.setGameHistory(m_historyKeys);
+	m_aiPlayer.setVerbose(!m_timeManager.isEnabled()); // Every iteration's log would bury the summary
+
+	if (!m_timeManager.isEnabled())
+	{
+		m_aiIterationDepth = m_aiDepth;
+		m_aiPlayer.setSearchLimits(SearchLimits());
+		m_aiPlayer.beginSearch(m_state, m_aiIterationDepth);
+		return true;
+	}
+
+	MoveList moves;
+	m_gameplay.generateMoves(m_state, moves);
+	bool threat = m_gameplay.countThreats(m_state, Player::Player1) + m_gameplay.countThreats(m_state, Player::Player2) > 0;
+	int movementPlies = m_record.getPlyCount() - m_record.getHeader().dropPlies;
+	m_timeManager.startMove(m_state.currentPlayer, moves.size(), movementPlies, m_drawRules.maxMovementPlies, threat);
+
+	// One legal move, or none: nothing to think about
+	if (m_timeManager.isInstant())
+	{
+		m_aiIterationDepth = 0;
+		if (!moves.empty()) m_aiBestMove = moves[0];
+		return false;
+	}
+
+	SearchLimits limits;
+	limits.deadline = m_timeManager.getHardDeadline();
+	m_aiPlayer.setSearchLimits(limits);
+	m_aiIterationDepth = 0;
+	m_aiPlayer.beginSearch(m_state, m_aiIterationDepth);
+	return true;
+}
 /**
  * @brief Executes the AI's turn during the movement phase.
  *
  * Uses minimax to compute best move, applies it, checks win,
- * and switches the current player.
+ * and switches the current player. The search runs in frame-sized
+ * slices, so it takes several calls before the move is played.
+ * On the clock it deepens one ply per iteration for as long as the
+ * time manager allows, a cut-off iteration keeps the last full one's move.
+ *
+ * @param t_frame Length of one frame.
  */
-void Game::handleAITurn()
+void Game::handleAITurn(sf::Time t_frame)
 {
 	
 	// Check if current player is AI
-	if ((m_currentPlayer == Player::Player1 && !m_player1IsAI) ||
-		(m_currentPlayer == Player::Player2 && !m_player2IsAI))
+	if ((m_state.currentPlayer == Player::Player1 && !m_player1IsAI) ||
+		(m_state.currentPlayer == Player::Player2 && !m_player2IsAI))
 	{
 		return;
 	}
 
-	std::cout << "AI ("
-		<< (m_currentPlayer == Player::Player1 ? "P1" : "P2")
-		<< ") is thinking...\n";
+	bool searching = true;
+	if (!m_aiThinking)
+	{
+		m_aiThinking = true;
+		searching = beginAIMove();
+	}
+
+	if (searching)
+	{
+		if (!m_aiPlayer.continueSearch(0, sliceDeadline(t_frame)))
+			return;
 
-	Boardstate currentState = getCurrentBoardState();
-	Move aiMove = m_aiPlayer.chooseBestMove(currentState, 3);
+		// An iteration is done
+		if (m_aiPlayer.wasStopped())
+		{
+			if (!m_aiBestMove.isValid()) m_aiBestMove = m_aiPlayer.getSearchResult();
+		}
+		else
+		{
+			const Move move = m_aiPlayer.getSearchResult();
+			const bool changed = m_aiBestMove.isValid() && (move.row1 != m_aiBestMove.row1 || move.col1 != m_aiBestMove.col1 ||
+				move.row2 != m_aiBestMove.row2 || move.col2 != m_aiBestMove.col2);
+			m_aiBestMove = move;
+
+			// A won or lost position does not get any clearer deeper down
+			const bool decided = std::abs(m_aiPlayer.getLastScore()) >= UNLIMITED_POWER;
+			if (m_timeManager.isEnabled() && move.isValid() && !decided && m_aiIterationDepth < MAX_AI_DEPTH &&
+				m_timeManager.shouldDeepen(changed))
+			{
+				m_aiPlayer.beginSearch(m_state, ++m_aiIterationDepth);
+				return;
+			}
+		}
+	}
+
+	m_aiThinking = false;
+	if (m_timeManager.isEnabled())
+	{
+		int used = m_timeManager.endMove();
+		std::cout << "AI took " << used << " ms, depth " << m_aiIterationDepth << ", "
+			<< m_timeManager.getRemainingMs(m_state.currentPlayer) << " ms left on its clock\n";
+
+		// A cut-off iteration's move is not played, the one before it is
+		const bool cutOff = m_aiPlayer.wasStopped() && m_aiIterationDepth > 0;
+		m_record.raiseSearchDepth(cutOff ? m_aiIterationDepth - 1 : m_aiIterationDepth);
+	}
+
+	Move aiMove = m_aiBestMove;
 
 	if (!aiMove.isValid())
 	{
@@ -1081,43 +1425,15 @@ void Game::handleAITurn()
 		return;
 	}
 
-	m_grid[aiMove.row2][aiMove.col2] = m_grid[aiMove.row1][aiMove.col1];
-	m_grid[aiMove.row1][aiMove.col1] = Animal();
-
-	// Move sprite
-	m_grid[aiMove.row2][aiMove.col2].initAnimalTexture(m_board.getCellSize());
-	m_grid[aiMove.row2][aiMove.col2].setPosition(m_board.getCellCenter(aiMove.row2, aiMove.col2));
+	applyMove(aiMove);
 
 	if (checkWinCondition())
 	{
-		m_winner = m_currentPlayer;
+		m_winner = m_state.currentPlayer;
 		switchGameState(GameState::GameOver);
 		return;
 	}
 
 	// Switches between P1 and P2 
-	m_currentPlayer = (m_currentPlayer == Player::Player1)
-		? Player::Player2 : Player::Player1;
-}
-
-
-/**
- * @brief Converts the current game grid into a Boardstate used by the AI.
- * @return Boardstate version of m_grid.
- */
-Boardstate Game::getCurrentBoardState() const
-{
-	Boardstate state;
-
-	// Copy the grid
-	for (int row = 0; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col < BOARD_SIZE; ++col) {
-			state.grid[row][col] = m_gameplay.toPieceState(m_grid[row][col]);
-		}
-	}
-
-	// Set current player
-	state.currentPlayer = m_currentPlayer;
-
-	return state;
+	endTurn();
 }
@@ -8,6 +8,11 @@
 #include "Board.h"
 #include "Animal.h"
 #include "Gameplay.h"
+#include "NeuralEvaluator.h"
+#include "SpriteBatch.h"
+#include "GameRecord.h"
+#include "TimeManager.h"
+#include "TranspositionTable.h"
 
 /// @brief Background clear colour.
 const sf::Color BLACK{ 0, 0, 0, 0 };
@@ -65,17 +70,27 @@ public:
 private:
 	// ------------ Core Loop ------------
 	void processEvents();   ///< Poll and handle SFML events
+	void handleEvent(const std::optional<sf::Event>& newEvent); ///< Handle one SFML event
+	bool isAnimating() const; ///< True while the screen changes without input (menu pulse, AI turn)
 	void processKeys(const std::optional<sf::Event> t_event); ///< Handle key press events
 	void checkKeyboardState(); ///< Check real-time keyboard input
 	void update(sf::Time t_deltaTime); ///< Update game logic
 	void render(); ///< Render all game graphics
+	void rebuildScene(); ///< Refills m_sprites from the board and the hands
 
 	// ------------ Gameplay Logic ------------
 	void updateAnimals(); ///< Update positions/scales when window resizes
 	void handleMousePress(sf::Vector2i mousePos); ///< Handle mouse down
 	void handleMouseRelease(sf::Vector2i mousePos); ///< Handle mouse release
 	void handleMouseMoved(sf::Vector2i mousePos); ///< Handle mouse drag
-	bool checkWinCondition(); ///< Checks 4-in-a-row for current player
+	bool checkWinCondition(); ///< Checks WIN_LENGTH in a row for current player
+	bool checkDrawCondition(); ///< Checks m_drawRules against the positions played so far
+	void placePiece(int row, int col, Player owner, AnimalType type); ///< Drops a piece from the hand onto the board
+	void applyMove(const Move& move); ///< Moves a piece on the board
+	void endTurn(); ///< Switches the player to move and records the position in m_history
+	void syncCell(int row, int col); ///< Updates one board Animal from m_state
+	void beginRecording(); ///< Seeds rand and starts m_record for a new game
+	void saveRecording(); ///< Writes m_record to the RECORDS folder
 	void switchGameState(GameState newState); ///< Transition between phases
 	void resetGame(); ///< Reset everything back to MainMenu
 
@@ -94,10 +109,20 @@ private:
 
 	// ------------ Game Data ------------
 
-	Board m_board{ 5, 150.f }; ///< 55 board
+	Board m_board{ BOARD_SIZE, 150.f }; ///< BOARD_SIZE x BOARD_SIZE board
+	SpriteBatch m_sprites; ///< Grid and pieces drawn in one call
+	bool m_sceneDirty{ true }; ///< Set whenever a piece or the layout changes, m_sprites is refilled on the next frame
+	bool m_needsRedraw{ true }; ///< Set by input and animations that change what is on screen outside the scene
+	bool m_renderOnDemand{ true }; ///< Draw only changed frames and sleep while idle; false redraws every loop
 	std::vector<Animal> m_player1Pieces; ///< P1 unplaced pieces
 	std::vector<Animal> m_player2Pieces; ///< P2 unplaced pieces
-	Animal m_grid[BOARD_SIZE][BOARD_SIZE]{}; ///< Placed animals
+	Animal m_grid[BOARD_SIZE][BOARD_SIZE]{}; ///< Placed animals, a view of m_state kept in sync by syncCell
+
+	Boardstate m_state; ///< The game itself: pieces on the board and the player to move
+	std::vector<Boardstate> m_history; ///< Start position and the position after every turn, oldest first
+	std::vector<std::uint64_t> m_historyKeys; ///< positionKey of every entry of m_history
+	DrawRules m_drawRules; ///< When a movement phase that goes nowhere ends as a draw
+	GameRecord m_record; ///< Drops and moves of the current game, saved when it ends
 
 	sf::RenderWindow m_window; ///< Main SFML window
 	sf::Font m_jerseyFont; ///< Primary UI font
@@ -110,6 +135,7 @@ private:
 	sf::Text m_menuSubtitle{ m_jerseyFont };
 	sf::Text m_menuCredits{ m_jerseyFont };
 	sf::Clock m_animationClock;
+	int m_startupTextureDecodes{ 0 }; ///< Image decodes done while the game was being set up
 
 	// --- Old/unused items (kept for reference) ---
 	sf::Text m_DELETEwelcomeMessage{ m_jerseyFont };
@@ -118,7 +144,6 @@ private:
 
 	// --- Game State / Turn Handling ---
 	GameState m_currentGameState{ GameState::Placement };
-	Player m_currentPlayer{ Player::Player1 };
 	Player m_winner{ Player::NoPlayer };
 
 	int m_player1PiecesPlaced{ 0 };
@@ -133,7 +158,7 @@ private:
 	bool m_isPieceSelected{ false };
 	sf::Vector2i m_selectedCell{ -1, -1 };
 	sf::Vector2i m_originalCell{ -1, -1 };
-	std::vector<sf::Vector2i> m_validMoves;
+	MoveList m_validMoves;
 	Animal* m_selectedPiece{ nullptr };
 
 	// --- Exit flag ---
@@ -142,18 +167,46 @@ private:
 	// --- AI Logic ---
 	Gameplay m_aiPlayer;
 	Gameplay m_gameplay;
+	NeuralEvaluator m_network; ///< Used by m_aiPlayer when ASSETS/NETWORK has weights
 	bool m_player2IsAI{ true };
 	bool m_player1IsAI{ false };
+	int m_aiDepth{ 3 }; ///< Depth of the move hints, and of AI players when there is no clock
+	TimeManager m_timeManager; ///< AI players' clocks and the budget of each search
+	TranspositionTable m_aiTable{ 16 }; ///< Lets each iteration of an AI search start from the last
+	bool m_aiThinking{ false }; ///< An AI player's move has been started and not played yet
+	int m_aiIterationDepth{ 0 }; ///< Depth of the iteration being searched
+	Move m_aiBestMove; ///< Move of the deepest finished iteration
+	sf::Time m_renderTime; ///< How long the last frame took to draw, the AI searches in what is left
+
+	Gameplay m_hintSearch; ///< Multi-PV search behind the move hints, run a slice per frame on a human's turn
+	TranspositionTable m_hintTable{ 4 }; ///< Shared by every line and slice of the hint search, cleared for each new position
+	std::vector<ScoredMove> m_hints; ///< Best moves of the position m_hintKey, best first
+	std::uint64_t m_hintKey{ 0 }; ///< positionKey the hints are for, 0 for none
+
+	/**
+	 * @brief End of a search slice that fits in this frame after drawing it.
+	 * @param t_frame Length of one frame.
+	 */
+	std::chrono::steady_clock::time_point sliceDeadline(sf::Time t_frame) const;
+
+	/**
+	 * @brief Keeps m_hints up to date while a human is to move, a slice per frame.
+	 * @param t_frame Length of one frame.
+	 */
+	void updateHints(sf::Time t_frame);
 
 	/**
-	 * @brief Performs AI decision making for current player's turn.
+	 * @brief Performs AI decision making for current player's turn, a slice at a time.
+	 *        The first call starts the search, the call that finishes it plays the move.
+	 * @param t_frame Length of one frame.
 	 */
-	void handleAITurn();
+	void handleAITurn(sf::Time t_frame);
 
 	/**
-	 * @brief Converts live grid to AI friendly Boardstate.
+	 * @brief Plans an AI move on the clock and starts its first iteration.
+	 * @return false if the move is forced and there is nothing to search.
 	 */
-	Boardstate getCurrentBoardState() const;
+	bool beginAIMove();
 
 	// --- Menu Buttons ---
 	MenuButton* m_btnHvH{};
@@ -0,0 +1,285 @@
+#include "GameAnalysis.h"
+#include "TranspositionTable.h"
+#include "PositionString.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <thread>
+
+/// Iterative deepening never goes past this, the search does not get there in time anyway.
+static const int MAX_ANALYSIS_DEPTH = 16;
+
+static bool sameMove(const Move& a, const Move& b)
+{
+	return a.row1 == b.row1 && a.col1 == b.col1 && a.row2 == b.row2 && a.col2 == b.col2;
+}
+
+/**
+ * @brief Quotes a string for JSON, Windows paths are full of backslashes.
+ */
+static std::string jsonString(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if (c == '\\' || c == '"') quoted += '\\';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+/**
+ * @brief Quotes a CSV field, doubling any quotes in it, so commas in a path stay in one column.
+ */
+static std::string csvString(const std::string& text)
+{
+	std::string quoted = "\"";
+	for (char c : text)
+	{
+		if (c == '"') quoted += '"';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+/**
+ * @brief Score the played move gave away, 0 if it scored above the best move
+ *        (moves past the root cap are not searched by chooseBestMove).
+ */
+static int moveLoss(const AnalysedMove& move)
+{
+	return std::max(0, move.bestScore - move.playedScore);
+}
+
+/**
+ * @brief Searches the position before a move to depth, then the played move alone as a
+ *        root move of the same search. The mover evaluates both, so the two scores are on
+ *        one scale: evaluateBoard does not weigh the two sides alike.
+ * @param keys Positions of the game up to the one before the move.
+ * @return false if a limit stopped either search, the scores are then not set.
+ */
+static bool searchMove(Gameplay& rules, const std::vector<std::uint64_t>& keys, const Boardstate& state,
+	int depth, AnalysedMove& analysed)
+{
+	rules.setGameHistory(keys);
+	analysed.best = rules.chooseBestMove(state, depth);
+	if (rules.wasStopped())
+		return false;
+	analysed.bestScore = rules.getLastScore();
+	analysed.depth = depth;
+
+	if (sameMove(analysed.played, analysed.best)) {
+		analysed.playedScore = analysed.bestScore;
+		return true;
+	}
+
+	analysed.playedScore = rules.scoreMove(state, analysed.played, depth);
+	return !rules.wasStopped();
+}
+
+/**
+ * @brief Lists the records, starts the workers, waits for them and writes the report.
+ */
+int GameAnalysis::run(const AnalysisSettings& settings)
+{
+	std::vector<std::string> files;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(settings.directory, error))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".fpgr") {
+			files.push_back(entry.path().string());
+		}
+	}
+	// Same report for the same directory, whatever order the file system lists it in
+	std::sort(files.begin(), files.end());
+
+	int threads = std::max(1, settings.threads);
+	std::cout << "Analysing " << files.size() << " games in " << settings.directory << " at ";
+	if (settings.timeMs > 0) std::cout << settings.timeMs << "ms";
+	else std::cout << "depth " << settings.depth;
+	std::cout << " per position on " << threads << " threads -> " << settings.outputPrefix << ".csv/.json\n";
+
+	std::vector<AnalysedGame> games(files.size());
+	std::atomic<int> nextGame{ 0 };
+	std::atomic<std::size_t> positions{ 0 };
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < threads; ++thread) {
+		workers.emplace_back(&GameAnalysis::worker, std::cref(settings), std::cref(files),
+			std::ref(games), std::ref(nextGame), std::ref(positions));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	int blunders = 0;
+	int invalid = 0;
+	for (const AnalysedGame& game : games)
+	{
+		invalid += !game.valid;
+		for (const AnalysedMove& move : game.moves) {
+			blunders += move.blunder;
+		}
+	}
+
+	std::cout << "Analysed " << positions << " positions from " << files.size() << " games ("
+		<< invalid << " unreadable) in " << seconds << "s, "
+		<< static_cast<long long>(files.size() * 60 / std::max(seconds, 1e-9)) << " games/min, "
+		<< blunders << " blunders\n";
+
+	if (!writeReport(settings, games)) {
+		std::cout << "Cannot write " << settings.outputPrefix << ".csv/.json\n";
+		return -1;
+	}
+
+	return blunders;
+}
+
+/**
+ * @brief Replays each game once, searching the position before every board move
+ *        and the move that was played in it.
+ */
+void GameAnalysis::worker(const AnalysisSettings& settings, const std::vector<std::string>& files,
+	std::vector<AnalysedGame>& games, std::atomic<int>& nextGame, std::atomic<std::size_t>& positions)
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+
+	// Kept across games: the evaluator never changes, so old entries stay correct
+	TranspositionTable table(settings.hashMegabytes);
+	rules.setTranspositionTable(&table);
+
+	for (int game = nextGame++; game < static_cast<int>(files.size()); game = nextGame++)
+	{
+		AnalysedGame& result = games[game];
+		result.file = files[game];
+
+		GameRecord record;
+		if (!record.load(files[game]))
+			continue;
+
+		const GameRecordHeader& header = record.getHeader();
+		result.winner = static_cast<Player>(header.winner);
+		result.valid = true;
+
+		Boardstate state;
+		state.clear(Player::Player1);
+		for (int ply = 0; ply < header.dropPlies && result.valid; ++ply) {
+			result.valid = record.applyPly(state, ply);
+		}
+
+		// Earlier positions of the game count as draws in the search, as they did for the players
+		std::vector<std::uint64_t> keys(1, Gameplay::positionKey(state));
+
+		for (int ply = header.dropPlies; ply < record.getPlyCount() && result.valid; ++ply)
+		{
+			AnalysedMove analysed;
+			analysed.ply = ply;
+			analysed.player = state.currentPlayer;
+			analysed.played = record.getMove(state, ply);
+			analysed.position = PositionString::toString(state, Hand());
+
+			Boardstate next = state;
+			if (!record.applyPly(next, ply)) {
+				result.valid = false;
+				break;
+			}
+
+			if (settings.timeMs > 0)
+			{
+				// The budget covers both searches of every depth. A depth either search did not
+				// finish is thrown away, the first always finishes so there is a result.
+				auto searchStart = std::chrono::steady_clock::now();
+				SearchLimits limits;
+				limits.deadline = searchStart + std::chrono::milliseconds(settings.timeMs);
+
+				for (int depth = 0; depth <= MAX_ANALYSIS_DEPTH; ++depth)
+				{
+					rules.setSearchLimits(depth == 0 ? SearchLimits() : limits);
+					AnalysedMove deeper = analysed;
+					if (!searchMove(rules, keys, state, depth, deeper))
+						break;
+					analysed = deeper;
+
+					auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - searchStart).count();
+					// A ply deeper usually costs a few times as much as everything so far
+					if (std::abs(analysed.bestScore) >= UNLIMITED_POWER || elapsed * 4 > settings.timeMs)
+						break;
+				}
+				rules.setSearchLimits(SearchLimits());
+			}
+			else
+			{
+				searchMove(rules, keys, state, settings.depth, analysed);
+			}
+			keys.push_back(Gameplay::positionKey(next));
+
+			analysed.blunder = moveLoss(analysed) >= settings.blunderThreshold && !sameMove(analysed.played, analysed.best);
+
+			result.moves.push_back(analysed);
+			positions++;
+			state = next;
+		}
+	}
+}
+
+/**
+ * @brief One CSV row per analysed move, one JSON object per game listing its blunders.
+ */
+bool GameAnalysis::writeReport(const AnalysisSettings& settings, const std::vector<AnalysedGame>& games)
+{
+	std::ofstream csv(settings.outputPrefix + ".csv");
+	std::ofstream json(settings.outputPrefix + ".json");
+	if (!csv || !json) {
+		return false;
+	}
+
+	csv << "file,ply,position,player,played,best,bestScore,playedScore,loss,depth,blunder\n";
+	for (const AnalysedGame& game : games)
+	{
+		for (const AnalysedMove& move : game.moves)
+		{
+			csv << csvString(game.file) << "," << move.ply << "," << move.position << "," << static_cast<int>(move.player) << ","
+				<< PositionString::moveText(move.played) << "," << PositionString::moveText(move.best) << ","
+				<< move.bestScore << "," << move.playedScore << "," << moveLoss(move) << ","
+				<< move.depth << "," << (move.blunder ? 1 : 0) << "\n";
+		}
+	}
+
+	// A timed run searches each position as deep as its budget reaches, the depth is per move
+	json << "{\n  \"depth\": ";
+	if (settings.timeMs > 0) json << "null";
+	else json << settings.depth;
+	json << ",\n  \"timeMs\": " << settings.timeMs
+		<< ",\n  \"blunderThreshold\": " << settings.blunderThreshold << ",\n  \"games\": [";
+	for (std::size_t i = 0; i < games.size(); ++i)
+	{
+		const AnalysedGame& game = games[i];
+		json << (i ? "," : "") << "\n    { \"file\": " << jsonString(game.file) << ", \"valid\": " << (game.valid ? "true" : "false")
+			<< ", \"winner\": " << static_cast<int>(game.winner) << ", \"moves\": " << game.moves.size() << ", \"blunders\": [";
+
+		bool first = true;
+		for (const AnalysedMove& move : game.moves)
+		{
+			if (!move.blunder)
+				continue;
+
+			json << (first ? "" : ",") << "\n      { \"ply\": " << move.ply << ", \"player\": " << static_cast<int>(move.player)
+				<< ", \"position\": \"" << move.position
+				<< "\", \"played\": \"" << PositionString::moveText(move.played) << "\", \"best\": \"" << PositionString::moveText(move.best)
+				<< "\", \"loss\": " << moveLoss(move) << ", \"depth\": " << move.depth << " }";
+			first = false;
+		}
+		json << (first ? "] }" : "\n    ] }");
+	}
+	json << "\n  ]\n}\n";
+
+	return static_cast<bool>(csv) && static_cast<bool>(json);
+}
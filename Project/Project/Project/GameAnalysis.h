@@ -0,0 +1,80 @@
+#pragma once
+#include "GameRecord.h"
+#include <atomic>
+#include <string>
+#include <vector>
+/**
+ * @file GameAnalysis.h
+ * @brief Offline re-analysis of recorded games, flagging moves that lost a lot of score.
+ */
+
+/**
+ * @struct AnalysisSettings
+ * @brief Options for one analysis run.
+ */
+struct AnalysisSettings {
+	std::string directory{ "RECORDS" };       ///< Every .fpgr file in here is analysed
+	int depth{ 3 };                           ///< chooseBestMove depth per position, used when timeMs is 0
+	int timeMs{ 0 };                          ///< Per position budget for the best move and the played move searches together, deepens one ply at a time until it is spent
+	int threads{ 1 };                         ///< Worker threads, each with its own Gameplay and table
+	int blunderThreshold{ 200 };              ///< Score lost by a move before it is called a blunder
+	std::size_t hashMegabytes{ 16 };          ///< Transposition table size per thread
+	std::string outputPrefix{ "analysis" };   ///< Report goes to prefix.csv and prefix.json
+};
+
+/**
+ * @struct AnalysedMove
+ * @brief One board move of a recorded game next to the engine's choice.
+ */
+struct AnalysedMove {
+	int ply;               ///< Ply number in the record, drops included
+	Player player;         ///< Side that played the move
+	std::string position;  ///< PositionString of the position the move was played in
+	Move played;
+	Move best;
+	int bestScore;         ///< Search score of the position, from the mover's point of view
+	int playedScore;       ///< Score of the played move at the same horizon
+	int depth;             ///< Depth the position was searched to
+	bool blunder;
+};
+
+/**
+ * @struct AnalysedGame
+ * @brief Every analysed move of one record.
+ */
+struct AnalysedGame {
+	std::string file;
+	bool valid{ false };   ///< False if the file could not be read or replayed
+	Player winner{ Player::NoPlayer };
+	std::vector<AnalysedMove> moves;
+};
+
+/**
+ * @class GameAnalysis
+ * @brief Searches every movement-phase position of a directory of game records on
+ *        every core and writes a CSV row per move and a JSON summary per game.
+ *
+ * Each worker keeps one transposition table for all of its games, so the search
+ * of a played move reuses most of the position's search.
+ */
+class GameAnalysis
+{
+public:
+	/**
+	 * @brief Analyses all records, writes the report and prints a summary.
+	 * @return Number of blunders found, -1 if the report could not be written.
+	 */
+	static int run(const AnalysisSettings& settings);
+
+private:
+	/**
+	 * @brief Takes game numbers from nextGame until every file is analysed.
+	 */
+	static void worker(const AnalysisSettings& settings, const std::vector<std::string>& files,
+		std::vector<AnalysedGame>& games, std::atomic<int>& nextGame, std::atomic<std::size_t>& positions);
+
+	/**
+	 * @brief Writes prefix.csv and prefix.json in file order.
+	 */
+	static bool writeReport(const AnalysisSettings& settings, const std::vector<AnalysedGame>& games);
+};
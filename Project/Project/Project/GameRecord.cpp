@@ -0,0 +1,263 @@
+#include "GameRecord.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static const char RECORD_MAGIC[4] = { 'F', 'P', 'G', 'R' };
+static const std::uint16_t RECORD_VERSION = 1;
+
+/// Row and column steps in RayTable order.
+static const int DIRECTION_STEPS[8][2] = { {1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+
+/**
+ * @brief Direction index of a from-to pair, -1 if they are not in a line.
+ */
+static int directionOf(const Move& move)
+{
+	int rowStep = (move.row2 > move.row1) - (move.row2 < move.row1);
+	int colStep = (move.col2 > move.col1) - (move.col2 < move.col1);
+
+	for (int direction = 0; direction < 8; ++direction)
+	{
+		if (DIRECTION_STEPS[direction][0] == rowStep && DIRECTION_STEPS[direction][1] == colStep)
+			return direction;
+	}
+	return -1;
+}
+
+GameRecord::GameRecord()
+{
+	begin(0, false, false, 0);
+}
+
+void GameRecord::begin(std::uint32_t seed, bool player1IsAI, bool player2IsAI, int searchDepth)
+{
+	std::memset(&m_header, 0, sizeof(m_header));
+	std::memcpy(m_header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC));
+	m_header.version = RECORD_VERSION;
+	m_header.boardSize = BOARD_SIZE;
+	m_header.winLength = WIN_LENGTH;
+	m_header.seed = seed;
+	m_header.player1IsAI = player1IsAI;
+	m_header.player2IsAI = player2IsAI;
+	m_header.searchDepth = static_cast<std::uint8_t>(searchDepth);
+	m_header.winner = Player::NoPlayer;
+
+	m_plies.clear();
+}
+
+void GameRecord::addDrop(int row, int col, AnimalType type)
+{
+	m_plies.push_back(static_cast<std::uint8_t>(((row * BOARD_SIZE + col) << 2) | type));
+	m_header.dropPlies++;
+	m_header.plies++;
+}
+
+void GameRecord::addDrops(const Boardstate& start)
+{
+	std::vector<int> cells[2];
+	for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+	{
+		Player owner = start.grid[cell / BOARD_SIZE][cell % BOARD_SIZE].owner;
+		if (owner != Player::NoPlayer) {
+			cells[owner == Player::Player1 ? 0 : 1].push_back(cell);
+		}
+	}
+
+	for (std::size_t i = 0; i < std::max(cells[0].size(), cells[1].size()); ++i)
+	{
+		for (const std::vector<int>& side : cells)
+		{
+			if (i < side.size()) {
+				int cell = side[i];
+				addDrop(cell / BOARD_SIZE, cell % BOARD_SIZE, start.grid[cell / BOARD_SIZE][cell % BOARD_SIZE].type);
+			}
+		}
+	}
+}
+
+void GameRecord::addMove(const Move& move)
+{
+	m_plies.push_back(static_cast<std::uint8_t>(((move.row1 * BOARD_SIZE + move.col1) << 3) | directionOf(move)));
+	m_header.plies++;
+}
+
+void GameRecord::raiseSearchDepth(int depth)
+{
+	m_header.searchDepth = static_cast<std::uint8_t>(std::max<int>(m_header.searchDepth, depth));
+}
+
+void GameRecord::setWinner(Player winner)
+{
+	m_header.winner = static_cast<std::uint8_t>(winner);
+}
+
+bool GameRecord::save(const std::string& path) const
+{
+	std::FILE* file = std::fopen(path.c_str(), "wb");
+	if (!file)
+		return false;
+
+	bool written = std::fwrite(&m_header, sizeof(m_header), 1, file) == 1 &&
+		std::fwrite(m_plies.data(), 1, m_plies.size(), file) == m_plies.size();
+
+	std::fclose(file);
+	return written;
+}
+
+bool GameRecord::load(const std::string& path)
+{
+	std::FILE* file = std::fopen(path.c_str(), "rb");
+	if (!file)
+		return false;
+
+	GameRecordHeader header;
+	bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+		std::memcmp(header.magic, RECORD_MAGIC, sizeof(RECORD_MAGIC)) == 0 &&
+		header.version == RECORD_VERSION &&
+		header.boardSize == BOARD_SIZE && header.winLength == WIN_LENGTH &&
+		header.dropPlies <= header.plies;
+
+	if (ok)
+	{
+		std::vector<std::uint8_t> plies(header.plies);
+		ok = std::fread(plies.data(), 1, plies.size(), file) == plies.size();
+		if (ok) {
+			m_header = header;
+			m_plies.swap(plies);
+		}
+	}
+
+	std::fclose(file);
+	return ok;
+}
+
+const GameRecordHeader& GameRecord::getHeader() const
+{
+	return m_header;
+}
+
+int GameRecord::getPlyCount() const
+{
+	return static_cast<int>(m_plies.size());
+}
+
+/**
+ * @brief Walks the ray for a board move: the neighbour if it is empty, else the first empty cell behind.
+ */
+Move GameRecord::getMove(const Boardstate& before, int ply) const
+{
+	if (ply < m_header.dropPlies || ply >= getPlyCount())
+		return Move();
+
+	const int cell = m_plies[ply] >> 3;
+	const int direction = m_plies[ply] & 7;
+	if (cell >= BOARD_SIZE * BOARD_SIZE)
+		return Move();
+
+	const PieceState& piece = before.grid[cell / BOARD_SIZE][cell % BOARD_SIZE];
+	const std::int8_t* ray = RAYS<BOARD_SIZE>.cells[cell][direction];
+	const int length = RAYS<BOARD_SIZE>.length[cell][direction];
+
+	int i = 0;
+	while (i < length && before.grid[ray[i] / BOARD_SIZE][ray[i] % BOARD_SIZE].owner != Player::NoPlayer)
+		++i;
+
+	// Only the frog gets past an occupied neighbour, and donkeys never move diagonally
+	if (i == length || (i > 0 && piece.type != AnimalType::Frog) ||
+		(direction >= 4 && piece.type == AnimalType::Donkey))
+		return Move();
+
+	return Move(cell / BOARD_SIZE, cell % BOARD_SIZE, ray[i] / BOARD_SIZE, ray[i] % BOARD_SIZE);
+}
+
+bool GameRecord::applyPly(Boardstate& state, int ply) const
+{
+	if (ply < 0 || ply >= getPlyCount())
+		return false;
+
+	if (ply < m_header.dropPlies)
+	{
+		const int cell = m_plies[ply] >> 2;
+		const AnimalType type = static_cast<AnimalType>(m_plies[ply] & 3);
+		if (cell >= BOARD_SIZE * BOARD_SIZE || type == AnimalType::NoType)
+			return false;
+
+		PieceState& target = state.grid[cell / BOARD_SIZE][cell % BOARD_SIZE];
+		if (target.owner != Player::NoPlayer)
+			return false;
+
+		target = { state.currentPlayer, type };
+	}
+	else
+	{
+		Move move = getMove(state, ply);
+		if (!move.isValid() || state.grid[move.row1][move.col1].owner != state.currentPlayer)
+			return false;
+
+		state.grid[move.row2][move.col2] = state.grid[move.row1][move.col1];
+		state.grid[move.row1][move.col1] = { Player::NoPlayer, AnimalType::NoType };
+	}
+
+	state.currentPlayer = (state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+	return true;
+}
+
+Boardstate GameRecord::positionAt(int ply) const
+{
+	Boardstate state;
+	state.clear(Player::Player1);
+
+	for (int i = 0; i < ply && applyPly(state, i); ++i) {}
+
+	return state;
+}
+
+// ------------ GameReplay ------------
+
+/**
+ * @brief One pass over the record, saving a keyframe every KEYFRAME_INTERVAL plies.
+ */
+GameReplay::GameReplay(const GameRecord& record) : m_record(record), m_plyCount(0), m_valid(true)
+{
+	Boardstate state;
+	state.clear(Player::Player1);
+	m_keyframes.push_back(state);
+
+	for (int ply = 0; ply < record.getPlyCount(); ++ply)
+	{
+		if (!record.applyPly(state, ply)) {
+			m_valid = false;
+			break;
+		}
+
+		m_plyCount = ply + 1;
+		if (m_plyCount % KEYFRAME_INTERVAL == 0) {
+			m_keyframes.push_back(state);
+		}
+	}
+}
+
+int GameReplay::getPlyCount() const
+{
+	return m_plyCount;
+}
+
+Boardstate GameReplay::seek(int ply) const
+{
+	ply = std::max(0, std::min(ply, m_plyCount));
+
+	int keyframe = ply / KEYFRAME_INTERVAL;
+	Boardstate state = m_keyframes[keyframe];
+
+	for (int i = keyframe * KEYFRAME_INTERVAL; i < ply; ++i) {
+		m_record.applyPly(state, i);
+	}
+
+	return state;
+}
+
+bool GameReplay::isValid() const
+{
+	return m_valid;
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+/**
+ * @file GameRecord.h
+ * @brief Compact binary game records and a replay engine with keyframes for fast seeking.
+ */
+
+/**
+ * @struct GameRecordHeader
+ * @brief First 20 bytes of a record file, one byte per ply follows.
+ */
+struct GameRecordHeader {
+	char magic[4];              ///< "FPGR"
+	std::uint16_t version;
+	std::uint8_t boardSize;
+	std::uint8_t winLength;
+	std::uint32_t seed;         ///< Seed of the random numbers the game was played with
+	std::uint8_t player1IsAI;
+	std::uint8_t player2IsAI;
+	std::uint8_t searchDepth;   ///< Deepest minimax depth an AI player's move was searched to
+	std::uint8_t winner;        ///< Player value, NoPlayer for an unfinished or drawn game
+	std::uint16_t plies;        ///< Number of ply bytes after the header
+	std::uint16_t dropPlies;    ///< How many of the first plies are drops from the hand
+};
+static_assert(sizeof(GameRecordHeader) == 20, "GameRecordHeader is written as is");
+static_assert(BOARD_SIZE * BOARD_SIZE <= 32, "A ply byte has five bits for the cell");
+
+/**
+ * @class GameRecord
+ * @brief A game as a header plus one byte per ply.
+ *
+ * A drop is (cell << 2) | animal type. A board move is (from cell << 3) | direction,
+ * in the RayTable direction order. The direction is enough because a piece has at
+ * most one move per direction: a step if the neighbour is empty, otherwise the
+ * frog's jump to the first empty cell behind the pieces. The owner of a drop and
+ * the mover are always the side to move, players alternate from Player 1.
+ */
+class GameRecord
+{
+public:
+	GameRecord();
+
+	/**
+	 * @brief Starts a new, empty record.
+	 * @param seed Seed the game's random numbers were drawn from.
+	 * @param player1IsAI Player 1 is played by the AI.
+	 * @param player2IsAI Player 2 is played by the AI.
+	 * @param searchDepth Minimax depth used by the AI players, 0 if they search on the clock.
+	 */
+	void begin(std::uint32_t seed, bool player1IsAI, bool player2IsAI, int searchDepth);
+
+	/**
+	 * @brief Raises the header's searchDepth to depth, for AI players that deepen on the clock.
+	 */
+	void raiseSearchDepth(int depth);
+
+	/**
+	 * @brief Appends a piece placed from the hand.
+	 */
+	void addDrop(int row, int col, AnimalType type);
+
+	/**
+	 * @brief Records a placed start position as drops, alternating from Player 1.
+	 *        Both players must have the same number of pieces on the board.
+	 */
+	void addDrops(const Boardstate& start);
+
+	/**
+	 * @brief Appends a move of a piece already on the board.
+	 */
+	void addMove(const Move& move);
+
+	/**
+	 * @brief Records the winner, NoPlayer for a draw.
+	 */
+	void setWinner(Player winner);
+
+	/**
+	 * @brief Writes header and plies to a file.
+	 * @return false if the file could not be written.
+	 */
+	bool save(const std::string& path) const;
+
+	/**
+	 * @brief Reads a record.
+	 * @return false if the file is missing, truncated or from a different board.
+	 */
+	bool load(const std::string& path);
+
+	const GameRecordHeader& getHeader() const;
+
+	/**
+	 * @brief Number of plies, drops included.
+	 */
+	int getPlyCount() const;
+
+	/**
+	 * @brief Applies one ply of this record to a position with make-move only.
+	 * @param state Position before the ply, updated in place.
+	 * @param ply Ply number, 0 is the first drop.
+	 * @return false if the ply does not fit the position (corrupt record).
+	 */
+	bool applyPly(Boardstate& state, int ply) const;
+
+	/**
+	 * @brief Board move played at a ply, an invalid Move for drops.
+	 * @param before Position the move was played in.
+	 */
+	Move getMove(const Boardstate& before, int ply) const;
+
+	/**
+	 * @brief Replays from the empty board, O(ply) without keyframes.
+	 * @return Position after the first ply plies.
+	 */
+	Boardstate positionAt(int ply) const;
+
+private:
+	GameRecordHeader m_header;
+	std::vector<std::uint8_t> m_plies;
+};
+
+/**
+ * @class GameReplay
+ * @brief Plays a record through once and keeps every KEYFRAME_INTERVAL-th position.
+ *
+ * Any ply is then reached from the nearest keyframe with fewer than
+ * KEYFRAME_INTERVAL moves, so seeking costs the same anywhere in the game.
+ * The record must outlive the replay.
+ */
+class GameReplay
+{
+public:
+	static const int KEYFRAME_INTERVAL = 16;
+
+	explicit GameReplay(const GameRecord& record);
+
+	/**
+	 * @brief Number of positions after the start, one per ply.
+	 */
+	int getPlyCount() const;
+
+	/**
+	 * @brief Position after the first ply plies; 0 is the empty board.
+	 */
+	Boardstate seek(int ply) const;
+
+	/**
+	 * @brief False if the record stopped making sense part way through.
+	 */
+	bool isValid() const;
+
+private:
+	const GameRecord& m_record;
+	std::vector<Boardstate> m_keyframes;
+	int m_plyCount;
+	bool m_valid;
+};
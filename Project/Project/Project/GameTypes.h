@@ -0,0 +1,59 @@
+#pragma once
+/**
+ * @file GameTypes.h
+ * @brief Plain data types shared by the rules, the AI and the UI.
+ */
+
+const int BOARD_SIZE = 5; ///< Cells per side of the board the game is played on
+const int WIN_LENGTH = 4; ///< Pieces in a row needed to win
+
+/**
+ * @enum Player
+ * @brief Represents which player owns a piece.
+ */
+enum Player {
+    NoPlayer,
+    Player1,
+    Player2
+};
+
+/**
+ * @enum AnimalType
+ * @brief Represents the type of animal.
+ */
+enum AnimalType {
+    NoType,
+    Frog,
+    Snake,
+    Donkey
+};
+
+/**
+ * @struct Move
+ * @brief Represents a move from one board coordinate to another.
+ */
+struct Move {
+	int row1, col1;
+	int row2, col2;
+
+	// Constructor for easy Move creation; we can use this to represent invalid moves or no-move
+	Move() : row1(-1), col1(-1), row2(-1), col2(-1) {}
+	Move(int r1, int c1, int r2, int c2) : row1(r1), col1(c1), row2(r2), col2(c2) {}
+
+	// Check if this is a valid move
+	bool isValid() const {
+		return row1 >= 0 && col1 >= 0 && row2 >= 0 && col2 >= 0;
+	}
+};
+
+/**
+ * @struct PieceState
+ * @brief Representation of a board piece used for AI calculations.
+ * Contains only owner and type.
+ */
+
+// No rendering information, otherwise performance will be TERRIBLE
+struct PieceState {
+	Player owner;
+	AnimalType type;
+};
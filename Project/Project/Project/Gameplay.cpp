@@ -1,11 +1,267 @@
 ﻿#include "Gameplay.h"
+#include "NeuralEvaluator.h"
+#include "TranspositionTable.h"
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+static const char* WEIGHT_NAMES[EvalWeights::COUNT] = { "threat", "opponentThreat", "build", "opponentBuild", "material", "center" };
+
+/**
+ * @brief Weight by index: threat, opponentThreat, build, opponentBuild, material, center.
+ */
+int& EvalWeights::operator[](int index)
+{
+	int* weights[COUNT] = { &threat, &opponentThreat, &build, &opponentBuild, &material, &center };
+	return *weights[index];
+}
+
+int EvalWeights::operator[](int index) const
+{
+	return const_cast<EvalWeights&>(*this)[index];
+}
+
+/**
+ * @brief Name of a weight in the weights file.
+ */
+const char* EvalWeights::name(int index)
+{
+	return WEIGHT_NAMES[index];
+}
+
+/**
+ * @brief Reads "name value" lines, lines starting with # are comments.
+ */
+bool EvalWeights::load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	std::string key;
+	while (file >> key)
+	{
+		if (key[0] == '#') {
+			std::getline(file, key);
+			continue;
+		}
+
+		int value = 0;
+		if (!(file >> value)) {
+			break;
+		}
+		for (int i = 0; i < COUNT; ++i) {
+			if (key == WEIGHT_NAMES[i]) {
+				(*this)[i] = value;
+			}
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Writes one "name value" line per weight.
+ */
+bool EvalWeights::save(const std::string& path) const
+{
+	std::ofstream file(path);
+	if (!file) {
+		return false;
+	}
+
+	for (int i = 0; i < COUNT; ++i) {
+		file << WEIGHT_NAMES[i] << " " << (*this)[i] << "\n";
+	}
+
+	return static_cast<bool>(file);
+}
+
+/**
+ * @brief Draw by repetition first, counting only the positions with the same side to move, then by length.
+ */
+bool DrawRules::isDraw(const std::vector<std::uint64_t>& keys, int movementPlies) const
+{
+	if (maxMovementPlies > 0 && movementPlies >= maxMovementPlies)
+		return true;
+
+	if (repetitions <= 0 || keys.empty())
+		return false;
+
+	// The key includes the side to move, so matching keys are always the same side
+	return std::count(keys.begin(), keys.end(), keys.back()) >= repetitions;
+}
+
 /**
  * @brief Gameplay constructor. Initializes AI settings.
  */
-Gameplay::Gameplay() : m_maximizingPlayer(Player::Player2), m_nodesEvaluated(0)
+template<int Size, int WinLength>
+BasicGameplay<Size, WinLength>::BasicGameplay() : m_maximizingPlayer(Player::Player2), m_nodesEvaluated(0), m_network(nullptr),
+	m_lastScore(0), m_verbose(true), m_table(nullptr), m_hash(0), m_stopped(false), m_keyFilter{}, m_threatDepth(2),
+	m_lines(1), m_searchDepth(0), m_rootKey(0)
+{
+}
+
+/**
+ * @brief Replaces the evaluation weights.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setWeights(const EvalWeights& weights)
+{
+	m_weights = weights;
+}
+
+/**
+ * @brief Current evaluation weights.
+ */
+template<int Size, int WinLength>
+const EvalWeights& BasicGameplay<Size, WinLength>::getWeights() const
+{
+	return m_weights;
+}
+
+/**
+ * @brief Score of the last chosen move.
+ */
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::getLastScore() const
+{
+	return m_lastScore;
+}
+
+/**
+ * @brief Enables or silences the search log.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setVerbose(bool verbose)
+{
+	m_verbose = verbose;
+}
+
+/**
+ * @brief Restarts the tie-break sequence. mt19937's output is fixed by the standard,
+ *        so a seed picks the same moves with every compiler.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setSeed(unsigned int seed)
+{
+	m_rng.seed(seed);
+}
+
+/**
+ * @brief Attaches (or with nullptr detaches) the leaf evaluation network.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setNeuralEvaluator(NeuralEvaluator* network)
+{
+	m_network = network;
+}
+
+/**
+ * @brief Attaches (or with nullptr detaches) the transposition table.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setTranspositionTable(TranspositionTable* table)
 {
+	m_table = table;
+}
+
+/**
+ * @brief Replaces the search limits.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setSearchLimits(const SearchLimits& limits)
+{
+	m_limits = limits;
+}
+
+/**
+ * @brief Replaces the game history, keeping the stack's storage.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setGameHistory(const std::vector<std::uint64_t>& keys)
+{
+	while (!m_keys.empty()) {
+		popKey();
+	}
+	for (std::uint64_t key : keys) {
+		pushKey(key);
+	}
+}
+
+/**
+ * @brief Whether the last search stopped early.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::wasStopped() const
+{
+	return m_stopped;
+}
+
+/**
+ * @brief Node count of the last search.
+ */
+template<int Size, int WinLength>
+std::uint64_t BasicGameplay<Size, WinLength>::getNodesEvaluated() const
+{
+	return m_nodesEvaluated;
+}
+
+/**
+ * @brief Follows the stored best moves from the position after first, stopping at a miss,
+ *        a move that is not legal any more (another position's entry) or a win.
+ */
+template<int Size, int WinLength>
+std::vector<Move> BasicGameplay<Size, WinLength>::getPrincipalVariation(const State& state, const Move& first, int maxLength)
+{
+	std::vector<Move> line;
+	if (!first.isValid())
+		return line;
+
+	line.push_back(first);
+	State position = makeMove(state, first);
+
+	Player winner;
+	MoveList moves;
+	while (m_table && static_cast<int>(line.size()) < maxLength && !checkWimCondition(position, winner))
+	{
+		TTEntry entry;
+		if (!m_table->probe(positionKey(position) ^ ZOBRIST<Size>.maximizer[m_maximizingPlayer], entry))
+			break;
+
+		generateMoves(position, moves);
+		auto found = std::find_if(moves.begin(), moves.end(), [&entry](const Move& move) {
+			return packMove(move, Size) == entry.move;
+		});
+		if (entry.move == 0 || found == moves.end())
+			break;
+
+		line.push_back(*found);
+		position = makeMove(position, *found);
+	}
+
+	return line;
+}
+
+/**
+ * @brief XOR of the key of every piece and the side to move.
+ */
+template<int Size, int WinLength>
+std::uint64_t BasicGameplay<Size, WinLength>::positionKey(const State& state)
+{
+	const ZobristKeys<Size>& keys = ZOBRIST<Size>;
+	std::uint64_t key = keys.sideToMove[state.currentPlayer];
+
+	for (int row = 0; row < Size; ++row) {
+		for (int col = 0; col < Size; ++col) {
+			const PieceState& piece = state.grid[row][col];
+			if (piece.owner != Player::NoPlayer) {
+				key ^= keys.piece[row * Size + col][piece.owner][piece.type];
+			}
+		}
+	}
+
+	return key;
 }
 
 /**
@@ -14,20 +270,42 @@ Gameplay::Gameplay() : m_maximizingPlayer(Player::Player2), m_nodesEvaluated(0)
  * @param depth Search depth.
  * @return Selected best Move.
  */
-Move Gameplay::chooseBestMove(const Boardstate& state, int depth)
+template<int Size, int WinLength>
+Move BasicGameplay<Size, WinLength>::chooseBestMove(const State& state, int depth)
 {
 	m_nodesEvaluated = 0;
+	m_stopped = false;
 	m_maximizingPlayer = state.currentPlayer;
 
-	std::vector<Move> possibleMoves = generateMoves(state);
+	// A forced win by threats is found in a fraction of the full search
+	Move threatMove;
+	if (m_threatDepth > 0 && findThreatWin(state, m_threatDepth, threatMove)) {
+		if (m_verbose) std::cout << "AI found a forced win by threats (evaluated " << m_nodesEvaluated << " nodes)\n";
+		m_lastScore = UNLIMITED_POWER;
+		return threatMove;
+	}
+
+	MoveList possibleMoves;
+	generateMoves(state, possibleMoves);
 
 	// Limit number of moves to evaluate for performance
-	if (possibleMoves.size() > 30) {
-		possibleMoves.resize(30);
+	if (possibleMoves.count > 30) {
+		possibleMoves.count = 30;
+	}
+
+	// The previous iteration's best move first, so the rest are searched against its score
+	std::uint64_t rootKey = 0;
+	if (m_table) {
+		rootKey = positionKey(state) ^ ZOBRIST<Size>.maximizer[m_maximizingPlayer];
+		TTEntry entry;
+		if (m_table->probe(rootKey, entry)) {
+			orderTableMove(entry.move, possibleMoves);
+		}
 	}
 
 	if (possibleMoves.empty()) {
-		std::cout << "No valid moves available!\n";
+		if (m_verbose) std::cout << "No valid moves available!\n";
+		m_lastScore = 0;
 		return Move();
 	}
 
@@ -39,18 +317,32 @@ Move Gameplay::chooseBestMove(const Boardstate& state, int depth)
 
 	std::vector<Move> bestMoves; // To store moves with the best score
 
-	std::cout << "AI evaluating " << possibleMoves.size() << " possible moves...\n";
+	if (m_verbose) std::cout << "AI evaluating " << possibleMoves.size() << " possible moves...\n";
+
+	// One working copy for the whole search, moves are made and taken back in place
+	State searchState = state;
+	if (m_network) {
+		m_network->refresh(&searchState.grid[0][0], Size);
+	}
+	m_hash = positionKey(searchState);
+	pushKey(m_hash);
 
 	// Try each possible move and evaluate it
 	for (const Move& move : possibleMoves) {
 
-		// Apply the move to get a new board state
-		Boardstate newState = makeMove(state, move);
+		// Apply the move to the working board
+		doMove(searchState, move);
 
 		// Evaluate this move using minimax (opponent's turn, so minimizing)
-		int score = miniMax(newState, depth, false, alpha, beta);
+		int score = miniMax(searchState, depth, false, alpha, beta);
+		undoMove(searchState, move);
+
+		// The score of a move whose search was cut short means nothing
+		if (m_stopped) {
+			break;
+		}
 
-		std::cout << "Move (" << move.col1 << "," << move.row1 << ") -> (" << move.col2 << "," << move.row2 << ") scored: " << score << "\n";
+		if (m_verbose) std::cout << "Move (" << move.col1 << "," << move.row1 << ") -> (" << move.col2 << "," << move.row2 << ") scored: " << score << "\n";
 
 		// If this move is better than the best found so far, clear previous best moves and store this one
 		if (score > bestScore) {
@@ -66,16 +358,43 @@ Move Gameplay::chooseBestMove(const Boardstate& state, int depth)
 		alpha = std::max(alpha, score);
 	}
 
+	popKey();
+
 	// Randomly select from the best moves
 	if (!bestMoves.empty()) {
-		int randomIndex = rand() % bestMoves.size();
+		int randomIndex = static_cast<int>(m_rng() % bestMoves.size());
 		bestMove = bestMoves[randomIndex];
 	}
 
-	std::cout << "AI chose move with score " << bestScore << " (evaluated " << m_nodesEvaluated << " nodes)\n";
+	m_lastScore = bestScore;
+	if (m_table && !m_stopped) {
+		m_table->store(rootKey, bestScore, depth + 1, TranspositionTable::Exact, packMove(bestMove, Size));
+	}
+	if (m_verbose) std::cout << "AI chose move with score " << bestScore << " (evaluated " << m_nodesEvaluated << " nodes)\n";
 
 	return bestMove;
 }
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::scoreMove(const State& state, const Move& move, int depth)
+{
+	m_nodesEvaluated = 0;
+	m_stopped = false;
+	m_maximizingPlayer = state.currentPlayer;
+
+	State searchState = state;
+	if (m_network) {
+		m_network->refresh(&searchState.grid[0][0], Size);
+	}
+	m_hash = positionKey(searchState);
+	pushKey(m_hash);
+
+	doMove(searchState, move);
+	int score = miniMax(searchState, depth, false, -UNLIMITED_POWER, UNLIMITED_POWER);
+	undoMove(searchState, move);
+
+	popKey();
+	return score;
+}
 /**
  * @brief Minimax algorithm with alpha-beta pruning.
  * @param state Board state.
@@ -85,9 +404,13 @@ Move Gameplay::chooseBestMove(const Boardstate& state, int depth)
  * @param beta Beta bound.
  * @return Evaluation score.
  */
-int Gameplay::miniMax(const Boardstate& state, int depth, bool isMaximizing, int alpha, int beta)
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::miniMax(State& state, int depth, bool isMaximizing, int alpha, int beta)
 {
 	m_nodesEvaluated++;
+	if (limitReached()) {
+		return 0;
+	}
 
 	// Check if game is over before recursing
 	Player winner;
@@ -100,13 +423,53 @@ int Gameplay::miniMax(const Boardstate& state, int depth, bool isMaximizing, int
 		}
 	}
 
+	// Going round in circles gets nobody anywhere
+	if (isRepetition()) {
+		return DRAW_SCORE;
+	}
+
 	// Maximum depth reached, stop recursion
 	if (depth == 0) {
+		if (m_network) {
+			return m_network->evaluate(m_maximizingPlayer);
+		}
 		return evaluateBoard(state, m_maximizingPlayer);
 	}
 
+	// Reuse a result from another path to this position. Scores are from the maximizing
+	// player's point of view, so the key includes who that is.
+	const int alphaOrig = alpha;
+	const int betaOrig = beta;
+	std::uint64_t key = 0;
+	TTEntry entry{};
+	if (m_table) {
+		key = m_hash ^ ZOBRIST<Size>.maximizer[m_maximizingPlayer];
+
+		if (m_table->probe(key, entry) && entry.depth >= depth) {
+			if (entry.bound == TranspositionTable::Exact)
+				return entry.score;
+			if (entry.bound == TranspositionTable::Lower)
+				alpha = std::max(alpha, static_cast<int>(entry.score));
+			else
+				beta = std::min(beta, static_cast<int>(entry.score));
+
+			if (beta <= alpha)
+				return entry.score;
+		}
+	}
+
 	// Generate all possible moves for current player
-	std::vector<Move> possibleMoves = generateMoves(state);
+	MoveList possibleMoves;
+	generateMoves(state, possibleMoves);
+
+	// The move that was best here last time usually still is, and then cuts off early
+	if (m_table) {
+		orderTableMove(entry.move, possibleMoves);
+	}
+
+	int bestEval;
+	Move bestMove;
+	pushKey(m_hash);
 
 	// Evaluate all possible moves
 	if (isMaximizing) {
@@ -114,11 +477,15 @@ int Gameplay::miniMax(const Boardstate& state, int depth, bool isMaximizing, int
 		int maxEval = -UNLIMITED_POWER;
 
 		for (const Move& move : possibleMoves) {
-			Boardstate newState = makeMove(state, move);
+			doMove(state, move);
 
 			// Recursively evaluate this move
-			int eval = miniMax(newState, depth - 1, false, alpha, beta);
-			maxEval = std::max(maxEval, eval);
+			int eval = miniMax(state, depth - 1, false, alpha, beta);
+			undoMove(state, move);
+			if (eval > maxEval) {
+				maxEval = eval;
+				bestMove = move;
+			}
 
 			// Alpha-beta pruning
 			alpha = std::max(alpha, eval);
@@ -127,18 +494,22 @@ int Gameplay::miniMax(const Boardstate& state, int depth, bool isMaximizing, int
 			}
 		}
 
-		return maxEval;
+		bestEval = maxEval;
 	}
 	else {
 		// MIN NODE: Opponent is trying to minimize score
 		int minEval = UNLIMITED_POWER;
 
 		for (const Move& move : possibleMoves) {
-			Boardstate newState = makeMove(state, move);
+			doMove(state, move);
 
 			// Recursively evaluate this move
-			int eval = miniMax(newState, depth - 1, true, alpha, beta);
-			minEval = std::min(minEval, eval);
+			int eval = miniMax(state, depth - 1, true, alpha, beta);
+			undoMove(state, move);
+			if (eval < minEval) {
+				minEval = eval;
+				bestMove = move;
+			}
 
 			// Alpha-beta pruning
 			beta = std::min(beta, eval);
@@ -147,283 +518,584 @@ int Gameplay::miniMax(const Boardstate& state, int depth, bool isMaximizing, int
 			}
 		}
 
-		return minEval;
+		bestEval = minEval;
 	}
+
+	popKey();
+
+	// Scores below a stopped search are made up, neither return nor store them
+	if (m_stopped) {
+		return 0;
+	}
+
+	if (m_table) {
+		TranspositionTable::Bound bound = TranspositionTable::Exact;
+		if (bestEval <= alphaOrig)
+			bound = TranspositionTable::Upper;
+		else if (bestEval >= betaOrig)
+			bound = TranspositionTable::Lower;
+
+		m_table->store(key, bestEval, depth, bound, packMove(bestMove, Size));
+	}
+
+	return bestEval;
 }
 /**
- * @brief Heuristic evaluation of the board state.
- * @param state Current board.
- * @param maximizingPlayer Player being evaluated.
- * @return Numeric score for the board.
+ * @brief Runs the sliced search to the end in one go and returns its lines.
  */
-int Gameplay::evaluateBoard(const Boardstate& state, Player maximizingPlayer)
+template<int Size, int WinLength>
+std::vector<ScoredMove> BasicGameplay<Size, WinLength>::chooseBestMoves(const State& state, int depth, int lines)
 {
-	int score = 0;
+	beginSearch(state, depth, lines);
+	continueSearch(0, std::chrono::steady_clock::time_point::max());
+	return getSearchLines();
+}
+/**
+ * @brief chooseBestMove up to its move loop. The root is a maximizing frame one ply deeper
+ *        than the depth asked for, so its moves are searched exactly as chooseBestMove does.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::beginSearch(const State& state, int depth, int lines)
+{
+	abortSearch();
 
-	// assign opponent object Player 2 if maximizingPlayer is Player 1, and vice versa
-	Player opponent = (maximizingPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+	m_nodesEvaluated = 0;
+	m_stopped = false;
+	m_maximizingPlayer = state.currentPlayer;
+	m_searchDepth = depth;
+	m_searchResult = Move();
+	m_rootBest.clear();
+	m_rootLines.clear();
+	m_lines = std::max(lines, 1);
+
+	// As in chooseBestMove. Several lines want scores for more than the winning move.
+	if (m_lines == 1 && m_threatDepth > 0 && findThreatWin(state, m_threatDepth, m_searchResult)) {
+		if (m_verbose) std::cout << "AI found a forced win by threats (evaluated " << m_nodesEvaluated << " nodes)\n";
+		m_lastScore = UNLIMITED_POWER;
+		m_rootLines.push_back(ScoredMove{ m_searchResult, UNLIMITED_POWER });
+		return;
+	}
 
-	score += evaluateThreeInARow(state, maximizingPlayer) * 100;  // AI can win next turn
-	score -= evaluateThreeInARow(state, opponent) * 90;			  // Opponent can win next turn, slightly less important than AI winning
+	SearchFrame root{};
+	generateMoves(state, root.moves);
+	if (root.moves.count > 30) {
+		root.moves.count = 30;
+	}
 
-	score += evaluateTwoInARow(state, maximizingPlayer) * 30; // AI should build towards a win
-	score -= evaluateTwoInARow(state, opponent) * 25;		  // Opponent has potential to build towards a win, should block
+	m_rootKey = 0;
+	if (m_table) {
+		m_rootKey = positionKey(state) ^ ZOBRIST<Size>.maximizer[m_maximizingPlayer];
+		TTEntry entry;
+		if (m_table->probe(m_rootKey, entry)) {
+			orderTableMove(entry.move, root.moves);
+		}
+	}
 
-	// Valid tiles closer to the center should be more valuable than edge tiles
-	for (int row = 0; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col < BOARD_SIZE; ++col) {
-			if (state.grid[row][col].owner == Player::NoPlayer) continue;
+	if (root.moves.empty()) {
+		if (m_verbose) std::cout << "No valid moves available!\n";
+		m_lastScore = 0;
+		return;
+	}
 
-			if (state.grid[row][col].owner == maximizingPlayer) {
-				score += 10;
-				// Bonus for center
-				if (row >= 1 && row <= 3 && col >= 1 && col <= 3) score += 5;
-			}
-			else {
-				score -= 10;
-				if (row >= 1 && row <= 3 && col >= 1 && col <= 3) score -= 5;
+	if (m_verbose) std::cout << "AI evaluating " << root.moves.size() << " possible moves...\n";
+
+	m_searchState = state;
+	if (m_network) {
+		m_network->refresh(&m_searchState.grid[0][0], Size);
+	}
+	m_hash = positionKey(m_searchState);
+	pushKey(m_hash);
+
+	root.depth = depth + 1;
+	root.maximizing = true;
+	root.alpha = root.alphaOrig = -UNLIMITED_POWER;
+	root.beta = root.betaOrig = UNLIMITED_POWER;
+	root.best = -UNLIMITED_POWER;
+
+	// A frame per ply plus the root, reserved so no frame moves while it is being searched
+	m_frames.reserve(static_cast<std::size_t>(depth) + 2);
+	m_frames.push_back(root);
+}
+/**
+ * @brief miniMax's recursion unrolled onto m_frames. Every pass of the loop either
+ *        finishes the top frame or enters its next move, and the slice can only end
+ *        between two passes, where the board and the stacks agree.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::continueSearch(std::uint64_t nodes, std::chrono::steady_clock::time_point deadline)
+{
+	if (m_frames.empty())
+		return true;
+
+	const std::uint64_t sliceStart = m_nodesEvaluated;
+	while (true)
+	{
+		const SearchFrame& frame = m_frames.back();
+		if (m_stopped || frame.next == frame.moves.count)
+		{
+			if (m_frames.size() == 1) {
+				finishSearch();
+				return true;
 			}
+			foldScore(closeNode());
+			continue;
 		}
-	}
 
-	return score;
+		const std::uint64_t searched = m_nodesEvaluated - sliceStart;
+		if ((nodes != 0 && searched >= nodes) ||
+			(searched >= MIN_SLICE_NODES && (searched & 63) == 0 && std::chrono::steady_clock::now() >= deadline))
+			return false;
+
+		const int depth = frame.depth - 1;
+		const bool maximizing = !frame.maximizing;
+		const int alpha = frame.alpha;
+		const int beta = frame.beta;
+		doMove(m_searchState, frame.moves[frame.next]);
+
+		int score;
+		if (openNode(depth, maximizing, alpha, beta, score)) {
+			foldScore(score);
+		}
+	}
 }
 /**
- * @brief Calculates threats for a given player (3 in a row with an empty).
- * @return Number of threats.
+ * @brief Same checks in the same order as the top of miniMax.
  */
-int Gameplay::evaluateThreeInARow(const Boardstate& state, Player player)
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::openNode(int depth, bool isMaximizing, int alpha, int beta, int& score)
 {
-	int threeInARows = 0;
+	m_nodesEvaluated++;
+	if (limitReached()) {
+		score = 0;
+		return true;
+	}
 
-	// Horizontal threats
-	for (int row = 0; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			threeInARows += checkForThreeInARow(
-				state.grid[row][col].owner,
-				state.grid[row][col + 1].owner,
-				state.grid[row][col + 2].owner,
-				state.grid[row][col + 3].owner,
-				player
-			);
-		}
+	Player winner;
+	if (checkWimCondition(m_searchState, winner)) {
+		score = (winner == m_maximizingPlayer) ? UNLIMITED_POWER : -UNLIMITED_POWER;
+		return true;
 	}
 
-	// Vertical threats
-	for (int col = 0; col < BOARD_SIZE; ++col) {
-		for (int row = 0; row <= BOARD_SIZE - 4; ++row) {
-			threeInARows += checkForThreeInARow(
-				state.grid[row][col].owner,
-				state.grid[row + 1][col].owner,
-				state.grid[row + 2][col].owner,
-				state.grid[row + 3][col].owner,
-				player
-			);
-		}
+	if (isRepetition()) {
+		score = DRAW_SCORE;
+		return true;
 	}
 
-	// Diagonal threats (top-left to bottom-right)
-	for (int row = 0; row <= BOARD_SIZE - 4; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			threeInARows += checkForThreeInARow(
-				state.grid[row][col].owner,
-				state.grid[row + 1][col + 1].owner,
-				state.grid[row + 2][col + 2].owner,
-				state.grid[row + 3][col + 3].owner,
-				player
-			);
-		}
+	if (depth == 0) {
+		score = m_network ? m_network->evaluate(m_maximizingPlayer) : evaluateBoard(m_searchState, m_maximizingPlayer);
+		return true;
 	}
 
-	// Diagonal threats (bottom-left to top-right)
-	for (int row = 3; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			threeInARows += checkForThreeInARow(
-				state.grid[row][col].owner,
-				state.grid[row - 1][col + 1].owner,
-				state.grid[row - 2][col + 2].owner,
-				state.grid[row - 3][col + 3].owner,
-				player
-			);
+	SearchFrame frame{};
+	frame.depth = depth;
+	frame.maximizing = isMaximizing;
+	frame.alphaOrig = alpha;
+	frame.betaOrig = beta;
+
+	TTEntry entry{};
+	if (m_table) {
+		frame.key = m_hash ^ ZOBRIST<Size>.maximizer[m_maximizingPlayer];
+
+		if (m_table->probe(frame.key, entry) && entry.depth >= depth) {
+			if (entry.bound == TranspositionTable::Exact) {
+				score = entry.score;
+				return true;
+			}
+			if (entry.bound == TranspositionTable::Lower)
+				alpha = std::max(alpha, static_cast<int>(entry.score));
+			else
+				beta = std::min(beta, static_cast<int>(entry.score));
+
+			if (beta <= alpha) {
+				score = entry.score;
+				return true;
+			}
 		}
 	}
 
-	return threeInARows;
+	generateMoves(m_searchState, frame.moves);
+	if (m_table) {
+		orderTableMove(entry.move, frame.moves);
+	}
+
+	frame.alpha = alpha;
+	frame.beta = beta;
+	frame.best = isMaximizing ? -UNLIMITED_POWER : UNLIMITED_POWER;
+	pushKey(m_hash);
+	m_frames.push_back(frame);
+	return false;
 }
 /**
- * @brief Checks whether 4 tiles form a threat condition.
+ * @brief Same as the end of miniMax.
  */
-int Gameplay::checkForThreeInARow(Player p1, Player p2, Player p3, Player p4, Player player)
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::closeNode()
 {
-	int playerCount = 0;
-	int emptyCount = 0;
+	const SearchFrame frame = m_frames.back();
+	m_frames.pop_back();
+	popKey();
+
+	if (m_stopped) {
+		return 0;
+	}
+
+	if (m_table) {
+		TranspositionTable::Bound bound = TranspositionTable::Exact;
+		if (frame.best <= frame.alphaOrig)
+			bound = TranspositionTable::Upper;
+		else if (frame.best >= frame.betaOrig)
+			bound = TranspositionTable::Lower;
 
-	// Store player's positions in an array for easier checking
-	Player positions[4] = { p1, p2, p3, p4 };
+		m_table->store(frame.key, frame.best, frame.depth, bound, packMove(frame.bestMove, Size));
+	}
 
-	for (int i = 0; i < 4; ++i) 
+	return frame.best;
+}
+/**
+ * @brief At the root a stopped move's score is thrown away, like chooseBestMove's break.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::foldScore(int score)
+{
+	SearchFrame& frame = m_frames.back();
+	const Move move = frame.moves[frame.next++];
+	undoMove(m_searchState, move);
+
+	if (m_frames.size() == 1)
 	{
-		if (positions[i] == player)
-		{
-			playerCount++;
+		if (m_stopped)
+			return;
+
+		if (m_verbose) std::cout << "Move (" << move.col1 << "," << move.row1 << ") -> (" << move.col2 << "," << move.row2 << ") scored: " << score << "\n";
+
+		if (score > frame.best) {
+			frame.best = score;
+			m_rootBest.clear();
+			m_rootBest.push_back(move);
 		}
-		else if (positions[i] == Player::NoPlayer)  // Need to check for empty tiles in case 4th tile is actually owned by current player
-		{
-			emptyCount++;
+		else if (score == frame.best) {
+			m_rootBest.push_back(move);
+		}
+
+		// Behind moves with the same score, so a tie keeps the order the moves were searched in
+		auto position = std::upper_bound(m_rootLines.begin(), m_rootLines.end(), score,
+			[](int value, const ScoredMove& line) { return value > line.score; });
+		m_rootLines.insert(position, ScoredMove{ move, score });
+
+		// Later moves only need to beat the last of the lines, which for one line is the best
+		if (static_cast<int>(m_rootLines.size()) >= m_lines) {
+			frame.alpha = std::max(frame.alpha, m_rootLines[m_lines - 1].score);
 		}
 	}
+	else if (frame.maximizing)
+	{
+		if (score > frame.best) {
+			frame.best = score;
+			frame.bestMove = move;
+		}
+		frame.alpha = std::max(frame.alpha, score);
+	}
+	else
+	{
+		if (score < frame.best) {
+			frame.best = score;
+			frame.bestMove = move;
+		}
+		frame.beta = std::min(frame.beta, score);
+	}
 
-	return (playerCount == 3 && emptyCount == 1) ? 1 : 0;
+	// Cutoff, the rest of the moves are skipped. The root never cuts off, every move
+	// with the best score is a candidate.
+	if (m_frames.size() > 1 && frame.beta <= frame.alpha) {
+		frame.next = frame.moves.count;
+	}
 }
-
 /**
- * @brief Calculates number of 2-in-a-rows for a given player.
- * @return Number of 2-in-a-rows.
+ * @brief Same as the end of chooseBestMove.
  */
-int Gameplay::evaluateTwoInARow(const Boardstate& state, Player player)
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::finishSearch()
 {
-	int twoInARows = 0;
+	const int bestScore = m_frames.back().best;
+	m_frames.clear();
+	popKey();
 
-	// Horizontal 2-in-a-rows
-	for (int row = 0; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			twoInARows += checkForTwoInARow(
-				state.grid[row][col].owner,
-				state.grid[row][col + 1].owner,
-				state.grid[row][col + 2].owner,
-				state.grid[row][col + 3].owner,
-				player
-			);
-		}
+	m_searchResult = Move();
+	if (!m_rootBest.empty()) {
+		m_searchResult = m_rootBest[m_rng() % m_rootBest.size()];
 	}
 
-	// Vertical 2-in-a-rows
-	for (int col = 0; col < BOARD_SIZE; ++col) {
-		for (int row = 0; row <= BOARD_SIZE - 4; ++row) {
-			twoInARows += checkForTwoInARow(
-				state.grid[row][col].owner,
-				state.grid[row + 1][col].owner,
-				state.grid[row + 2][col].owner,
-				state.grid[row + 3][col].owner,
-				player
-			);
+	m_lastScore = bestScore;
+	if (m_table && !m_stopped) {
+		m_table->store(m_rootKey, bestScore, m_searchDepth + 1, TranspositionTable::Exact, packMove(m_searchResult, Size));
+	}
+	if (m_verbose) std::cout << "AI chose move with score " << bestScore << " (evaluated " << m_nodesEvaluated << " nodes)\n";
+}
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::isSearching() const
+{
+	return !m_frames.empty();
+}
+/**
+ * @brief Takes back every move on the path, so the key stack and the network are as they were.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::abortSearch()
+{
+	while (!m_frames.empty())
+	{
+		popKey();
+		m_frames.pop_back();
+		if (!m_frames.empty()) {
+			const SearchFrame& parent = m_frames.back();
+			undoMove(m_searchState, parent.moves[parent.next]);
 		}
 	}
+}
+template<int Size, int WinLength>
+Move BasicGameplay<Size, WinLength>::getSearchResult() const
+{
+	return m_searchResult;
+}
+/**
+ * @brief Moves further down the list only have upper bounds, they are left out.
+ */
+template<int Size, int WinLength>
+std::vector<ScoredMove> BasicGameplay<Size, WinLength>::getSearchLines() const
+{
+	const std::size_t count = std::min(m_rootLines.size(), static_cast<std::size_t>(m_lines));
+	return std::vector<ScoredMove>(m_rootLines.begin(), m_rootLines.begin() + count);
+}
+/**
+ * @brief Counts its nodes into getNodesEvaluated, it is part of the search that called it.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::findThreatWin(const State& state, int maxThreats, Move& move)
+{
+	return threatWin(state, std::max(maxThreats, 0), &move);
+}
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::setThreatDepth(int maxThreats)
+{
+	m_threatDepth = std::clamp(maxThreats, 0, MAX_THREAT_DEPTH);
+}
+/**
+ * @brief The line masks give the cells that would finish a line, only moves landing
+ *        on one of those are checked, and only against the lines through that cell.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::canWinNow(const State& state, Move* move)
+{
+	const Lines& lines = LINES<Size, WinLength>;
 
-	// Diagonal 2-in-a-rows (top-left to bottom-right)
-	for (int row = 0; row <= BOARD_SIZE - 4; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			twoInARows += checkForTwoInARow(
-				state.grid[row][col].owner,
-				state.grid[row + 1][col + 1].owner,
-				state.grid[row + 2][col + 2].owner,
-				state.grid[row + 3][col + 3].owner,
-				player
-			);
+	std::uint64_t ownBits, otherBits;
+	packBoard(state, state.currentPlayer, ownBits, otherBits);
+
+	std::uint64_t targets = 0;
+	for (int line = 0; line < Lines::COUNT; ++line)
+	{
+		const std::uint64_t mask = lines.mask[line];
+		if ((mask & otherBits) == 0 && countBits(mask & ownBits) == WinLength - 1) {
+			targets |= mask & ~ownBits;
 		}
 	}
+	if (targets == 0)
+		return false;
+
+	MoveList moves;
+	generateMoves(state, moves);
+	for (const Move& candidate : moves)
+	{
+		const std::uint64_t to = std::uint64_t(1) << (candidate.row2 * Size + candidate.col2);
+		if ((targets & to) == 0)
+			continue;
 
-	// Diagonal 2-in-a-rows (bottom-left to top-right)
-	for (int row = 3; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col) {
-			twoInARows += checkForTwoInARow(
-				state.grid[row][col].owner,
-				state.grid[row - 1][col + 1].owner,
-				state.grid[row - 2][col + 2].owner,
-				state.grid[row - 3][col + 3].owner,
-				player
-			);
+		// The piece may have come out of the very line it was meant to finish
+		const std::uint64_t after = (ownBits & ~(std::uint64_t(1) << (candidate.row1 * Size + candidate.col1))) | to;
+		for (int line = 0; line < Lines::COUNT; ++line)
+		{
+			const std::uint64_t mask = lines.mask[line];
+			if ((mask & to) != 0 && (after & mask) == mask) {
+				if (move) *move = candidate;
+				return true;
+			}
 		}
 	}
 
-	return twoInARows;
+	return false;
 }
 /**
- * @brief Checks whether 4 tiles contain exactly 2 of player's pieces and 2 empty.
+ * @brief An AND-OR search over threats. A move counts as a threat if the opponent cannot
+ *        win straight back and the mover could win next move. It wins if every reply
+ *        either leaves a win in one or loses to a shorter threat sequence. No legal
+ *        reply is not counted as a win, the full search scores that position.
  */
-int Gameplay::checkForTwoInARow(Player p1, Player p2, Player p3, Player p4, Player player)
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::threatWin(const State& state, int threats, Move* first)
 {
-	int playerCount = 0;
-	int emptyCount = 0;
-
-	// Store player's positions in an array for easier checking
-	Player positions[4] = { p1, p2, p3, p4 };
-
-	for (int i = 0; i < 4; ++i)
+	if (canWinNow(state, first))
+		return true;
+	if (threats == 0)
+		return false;
+
+	MoveList moves;
+	generateMoves(state, moves);
+	for (const Move& threat : moves)
 	{
-		if (positions[i] == player)
+		m_nodesEvaluated++;
+		const State next = makeMove(state, threat);
+		if (canWinNow(next, nullptr))
+			continue;
+
+		// Look at the board from the mover's side: is there a win in one to stop?
+		State threatened = next;
+		threatened.currentPlayer = state.currentPlayer;
+		if (!canWinNow(threatened, nullptr))
+			continue;
+
+		MoveList replies;
+		generateMoves(next, replies);
+		bool forced = !replies.empty();
+		for (const Move& reply : replies)
 		{
-			playerCount++;
+			m_nodesEvaluated++;
+			if (!threatWin(makeMove(next, reply), threats - 1, nullptr)) {
+				forced = false;
+				break;
+			}
 		}
-		else if (positions[i] == Player::NoPlayer)
-		{
-			emptyCount++;
+
+		if (forced) {
+			if (first) *first = threat;
+			return true;
 		}
 	}
 
-	// Return 1 if we have exactly 2 of our pieces and 2 empty spaces (potential to build towards 4-in-a-row)
-	return (playerCount == 2 && emptyCount == 2) ? 1 : 0;
+	return false;
 }
-
 /**
- * @brief Converts an Animal object to a PieceState representation.
+ * @brief Heuristic evaluation of the board state.
+ * @param state Current board.
+ * @param maximizingPlayer Player being evaluated.
+ * @return Numeric score for the board.
  */
-PieceState Gameplay::toPieceState(const Animal& animal)
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::evaluateBoard(const State& state, Player maximizingPlayer)
 {
-	PieceState pieceState;
-	pieceState.owner = animal.getOwner();
-	pieceState.type = animal.getType();
-	return pieceState;
+	int score = 0;
+
+	// Bit masks for the AI's pieces and the opponent's, every line test below is a mask test
+	std::uint64_t aiBits, opponentBits;
+	packBoard(state, maximizingPlayer, aiBits, opponentBits);
+
+	score += countOpenLines(aiBits, opponentBits, WinLength - 1) * m_weights.threat;  // AI can win next turn
+	score -= countOpenLines(opponentBits, aiBits, WinLength - 1) * m_weights.opponentThreat;	 // Opponent can win next turn, slightly less important than AI winning
+
+	score += countOpenLines(aiBits, opponentBits, WinLength - 2) * m_weights.build; // AI should build towards a win
+	score -= countOpenLines(opponentBits, aiBits, WinLength - 2) * m_weights.opponentBuild; // Opponent has potential to build towards a win, should block
+
+	// Valid tiles closer to the center (off the edge) should be more valuable than edge tiles
+	const std::uint64_t centerMask = LINES<Size, WinLength>.centerMask;
+	score += countBits(aiBits) * m_weights.material + countBits(aiBits & centerMask) * m_weights.center;
+	score -= countBits(opponentBits) * m_weights.material + countBits(opponentBits & centerMask) * m_weights.center;
+
+	return score;
 }
 /**
- * @brief Converts a PieceState back into a full Animal.
+ * @brief The same count evaluateBoard weighs with threat.
  */
-Animal Gameplay::toAnimal(const PieceState& pieceState)
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::countThreats(const State& state, Player player) const
 {
-	return Animal(pieceState.owner, pieceState.type);
+	std::uint64_t playerBits, opponentBits;
+	packBoard(state, player, playerBits, opponentBits);
+	return countOpenLines(playerBits, opponentBits, WinLength - 1);
 }
+/**
+ * @brief Packs the board into one occupancy mask per side.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::packBoard(const State& state, Player player, std::uint64_t& playerBits, std::uint64_t& opponentBits) const
+{
+	playerBits = 0;
+	opponentBits = 0;
 
+	// No branches: owners are close to random, so a branch per cell would mispredict constantly
+	for (int row = 0; row < Size; ++row) {
+		for (int col = 0; col < Size; ++col) {
+			Player owner = state.grid[row][col].owner;
+			int cell = row * Size + col;
+
+			playerBits |= std::uint64_t(owner == player) << cell;
+			opponentBits |= std::uint64_t(owner != player && owner != Player::NoPlayer) << cell;
+		}
+	}
+}
 /**
- * @brief Generates all possible moves for current player in state.
+ * @brief Counts lines with exactly `pieces` of the player's pieces and every other tile empty.
+ * @return Number of matching lines.
  */
-std::vector<Move> Gameplay::generateMoves(const Boardstate& state)
+template<int Size, int WinLength>
+int BasicGameplay<Size, WinLength>::countOpenLines(std::uint64_t playerBits, std::uint64_t opponentBits, int pieces) const
 {
-	std::vector<Move> moves;
+	const Lines& lines = LINES<Size, WinLength>;
+	int openLines = 0;
 
-	// Look at all board positions
-	for (int row = 0; row < BOARD_SIZE; ++row)
+	for (int line = 0; line < Lines::COUNT; ++line)
 	{
-		for (int col = 0; col < BOARD_SIZE; ++col)
-		{
-			const PieceState& piece = state.grid[row][col];
+		// A line blocked by the opponent can never be completed
+		bool open = (opponentBits & lines.mask[line]) == 0;
+		openLines += open & (countBits(playerBits & lines.mask[line]) == pieces);
+	}
+
+	return openLines;
+}
+
+/**
+ * @brief Generates all possible moves for current player in state.
+ */
+template<int Size, int WinLength>
+std::vector<Move> BasicGameplay<Size, WinLength>::generateMoves(const State& state)
+{
+	MoveList moves;
+	generateMoves(state, moves);
 
-			// Skip empty cells
-			if (piece.owner == Player::NoPlayer)
-				continue;
+	return std::vector<Move>(moves.begin(), moves.end());
+}
+/**
+ * @brief Generates all legal moves for the current player into a fixed-size list.
+ * @param state Board state.
+ * @param moves Output list.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::generateMoves(const State& state, MoveList& moves)
+{
+	moves.clear();
 
-			// Skip opponent's pieces
-			if (piece.owner != state.currentPlayer)
-				continue;
+	std::uint64_t playerBits, opponentBits;
+	packBoard(state, state.currentPlayer, playerBits, opponentBits);
+	const std::uint64_t occupied = playerBits | opponentBits;
 
-			// Get moves for this piece (Frog, Snake, Donkey)
-			std::vector<Move> pieceMoves = getValidMovesForPiece(row, col, state);
+	// Look at all of the current player's pieces
+	for (int cell = 0; cell < Size * Size; ++cell)
+	{
+		if (!(playerBits & MoveRules<Size>::bit(cell)))
+			continue;
 
-			// Append them
-			moves.insert(moves.end(), pieceMoves.begin(), pieceMoves.end());
-		}
+		// Get moves for this piece (Frog, Snake, Donkey)
+		MoveRules<Size>::addPieceMoves(cell / Size, cell % Size, state.grid[cell / Size][cell % Size].type, occupied, moves);
 	}
-
-	return moves;
 }
 /**
  * @brief Applies a move to a board and returns updated state.
  */
-Boardstate Gameplay::makeMove(const Boardstate& state, const Move& move)
+template<int Size, int WinLength>
+typename BasicGameplay<Size, WinLength>::State BasicGameplay<Size, WinLength>::makeMove(const State& state, const Move& move)
 {
 	// Create a copy of the current state
-	Boardstate newState;
-	for (int row = 0; row < BOARD_SIZE; ++row) {
-		for (int col = 0; col < BOARD_SIZE; ++col) {
+	State newState;
+	for (int row = 0; row < Size; ++row) {
+		for (int col = 0; col < Size; ++col) {
 			newState.grid[row][col] = state.grid[row][col];
 		}
 	}
@@ -441,209 +1113,225 @@ Boardstate Gameplay::makeMove(const Boardstate& state, const Move& move)
 	return newState;
 }
 /**
- * @brief Checks whether any player has four in a row.
- * @param state Current board state.
- * @param winner Output winner.
- * @return true if win detected.
+ * @brief Moves a piece in place and hands the change to the network.
+ * @param state Board to change.
+ * @param move Move from generateMoves, the destination is always empty.
  */
-bool Gameplay::checkWimCondition(const Boardstate& state, Player& winner)
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::doMove(State& state, const Move& move)
 {
-	// Check horizontal wins
-	for (int row = 0; row < BOARD_SIZE; ++row)
-	{
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col)
-		{
-			Player first = state.grid[row][col].owner;
-			if (first == Player::NoPlayer) continue;
-
-			bool aboutToWin = true;
-			for (int i = 1; i < 4; ++i)
-			{
-				if (state.grid[row][col + i].owner != first)
-				{
-					aboutToWin = false;
-					break;
-				}
-			}
-			if (aboutToWin)
-			{
-				winner = first;
-				return true;
-			}
-		}
+	PieceState piece = state.grid[move.row1][move.col1];
+
+	if (m_network) {
+		m_network->push();
+		m_network->movePiece(move.row1 * Size + move.col1, move.row2 * Size + move.col2, piece);
 	}
+	updateHash(move, piece);
 
-	// Check vertical wins
-	for (int col = 0; col < BOARD_SIZE; ++col)
-	{
-		for (int row = 0; row <= BOARD_SIZE - 4; ++row)
-		{
-			Player first = state.grid[row][col].owner;
-			if (first == Player::NoPlayer) continue;
-
-			bool aboutToWin = true;
-			for (int i = 1; i < 4; ++i)
-			{
-				if (state.grid[row + i][col].owner != first)
-				{
-					aboutToWin = false;
-					break;
-				}
-			}
-			if (aboutToWin)
-			{
-				winner = first;
-				return true;
-			}
-		}
+	state.grid[move.row2][move.col2] = piece;
+	state.grid[move.row1][move.col1] = { Player::NoPlayer, AnimalType::NoType };
+	state.currentPlayer = (state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+}
+/**
+ * @brief Puts the piece back and restores the network's previous accumulator.
+ * @param state Board the move was made on.
+ * @param move Same move that was passed to doMove.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::undoMove(State& state, const Move& move)
+{
+	if (m_network) {
+		m_network->pop();
 	}
+	updateHash(move, state.grid[move.row2][move.col2]);
 
-	// Check diagonal wins (top-left to bottom-right)
-	for (int row = 0; row <= BOARD_SIZE - 4; ++row)
-	{
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col)
-		{
-			Player first = state.grid[row][col].owner;
-			if (first == Player::NoPlayer) continue;
-
-			bool aboutToWin = true;
-			for (int i = 1; i < 4; ++i)
-			{
-				if (state.grid[row + i][col + i].owner != first)
-				{
-					aboutToWin = false;
-					break;
-				}
-			}
-			if (aboutToWin)
-			{
-				winner = first;
-				return true;
-			}
-		}
+	state.grid[move.row1][move.col1] = state.grid[move.row2][move.col2];
+	state.grid[move.row2][move.col2] = { Player::NoPlayer, AnimalType::NoType };
+	state.currentPlayer = (state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+}
+/**
+ * @brief Node limit every node, stop flag and deadline every 1024 nodes. Stays stopped once hit.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::limitReached()
+{
+	if (m_stopped)
+		return true;
+
+	if (m_limits.nodes != 0 && m_nodesEvaluated >= m_limits.nodes) {
+		m_stopped = true;
 	}
-	// Check diagonal wins (bottom-left to top-right)
-	for (int row = 3; row < BOARD_SIZE; ++row)
-	{
-		for (int col = 0; col <= BOARD_SIZE - 4; ++col)
-		{
-			Player first = state.grid[row][col].owner;
-			if (first == Player::NoPlayer) continue;
-
-			bool aboutToWin = true;
-			for (int i = 1; i < 4; ++i)
-			{
-				if (state.grid[row - i][col + i].owner != first)
-				{
-					aboutToWin = false;
-					break;
-				}
-			}
-			if (aboutToWin)
-			{
-				winner = first;
-				return true;
-			}
-		}
+	else if ((m_nodesEvaluated & 1023) == 0) {
+		m_stopped = (m_limits.stop && m_limits.stop->load(std::memory_order_relaxed)) ||
+			std::chrono::steady_clock::now() >= m_limits.deadline;
 	}
 
-	return false;
+	return m_stopped;
 }
+/**
+ * @brief Swaps the stored move to the front, keeping the rest in generation order.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::orderTableMove(std::uint16_t packed, MoveList& moves) const
+{
+	if (packed == 0)
+		return;
 
+	for (int i = 0; i < moves.count; ++i)
+	{
+		if (packMove(moves[i], Size) == packed) {
+			std::rotate(moves.moves, moves.moves + i, moves.moves + i + 1);
+			return;
+		}
+	}
+}
 /**
- * @brief Checks if board coordinate is within bounds.
+ * @brief Pushes the key and counts it in the filter.
  */
-bool Gameplay::isValidPosition(int row, int col) const
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::pushKey(std::uint64_t key)
 {
-	return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+	m_keys.push_back(key);
+	m_keyFilter[key & 4095]++;
 }
-
 /**
- * @brief Returns all valid moves for the piece at (row, col).
+ * @brief Pops the newest key and takes it out of the filter.
  */
-std::vector<Move> Gameplay::getValidMovesForPiece(int row, int col, const Boardstate& state)
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::popKey()
 {
-	std::vector<Move> moves;
-
-	Player owner = state.grid[row][col].owner;
-	AnimalType type = state.grid[row][col].type;
+	m_keyFilter[m_keys.back() & 4095]--;
+	m_keys.pop_back();
+}
+/**
+ * @brief Filter first, a scan of the stack only when some key could match.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::isRepetition() const
+{
+	if (m_keyFilter[m_hash & 4095] == 0)
+		return false;
 
-	if (owner == Player::NoPlayer)
-		return moves;
+	return std::find(m_keys.rbegin(), m_keys.rend(), m_hash) != m_keys.rend();
+}
+/**
+ * @brief The piece leaves the from cell, lands on the to cell and the other side is to move.
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::updateHash(const Move& move, const PieceState& piece)
+{
+	const ZobristKeys<Size>& keys = ZOBRIST<Size>;
 
-	static const int DIR4[4][2] = {
-		{1,0}, {-1,0}, {0,1}, {0,-1}
+	m_hash ^= keys.piece[move.row1 * Size + move.col1][piece.owner][piece.type];
+	m_hash ^= keys.piece[move.row2 * Size + move.col2][piece.owner][piece.type];
+	m_hash ^= keys.sideToMove[Player::Player1] ^ keys.sideToMove[Player::Player2];
+}
+/**
+ * @brief Places both sets of pieces at random to produce a movement phase start position.
+ */
+template<int Size, int WinLength>
+typename BasicGameplay<Size, WinLength>::State BasicGameplay<Size, WinLength>::randomStartingPosition(std::mt19937& rng)
+{
+	// Same order the AI takes pieces off the back of its list in Game
+	static const AnimalType PLACEMENT_ORDER[5] = {
+		AnimalType::Donkey, AnimalType::Donkey, AnimalType::Donkey, AnimalType::Snake, AnimalType::Frog
 	};
 
-	static const int DIR8[8][2] = {
-		{1,0}, {-1,0}, {0,1}, {0,-1},
-		{1,1}, {1,-1}, {-1,1}, {-1,-1}
-	};
+	BasicGameplay rules;
+	State state;
 
-	// Donkey moves (4 directions, 1 step)
-	if (type == AnimalType::Donkey)
+	while (true)
 	{
-		for (auto& direction : DIR4)
-		{
-			int neighbourRow = row + direction[0];
-			int neighbourCol = col + direction[1];
-			if (isValidPosition(neighbourRow, neighbourCol) && state.grid[neighbourRow][neighbourCol].owner == Player::NoPlayer)
-			{
-				moves.push_back({ row, col, neighbourRow, neighbourCol });
-			}
-		}
-	}
+		state.clear(Player::Player1);
 
-	// Snake moves (8 directions, 1 step)
-	else if (type == AnimalType::Snake)
-	{
-		for (auto& direction : DIR8)
+		bool someoneWon = false;
+		for (int i = 0; i < 10 && !someoneWon; ++i)
 		{
-			int neighbourRow = row + direction[0];
-			int neighbourCol = col + direction[1];
-			if (isValidPosition(neighbourRow, neighbourCol) && state.grid[neighbourRow][neighbourCol].owner == Player::NoPlayer)
-			{
-				moves.push_back({ row, col, neighbourRow, neighbourCol });
-			}
+			Player owner = (i % 2 == 0) ? Player::Player1 : Player::Player2;
+
+			// Keep drawing until we hit an empty cell, the board is never close to full
+			int row, col;
+			do {
+				row = static_cast<int>(rng() % Size);
+				col = static_cast<int>(rng() % Size);
+			} while (state.grid[row][col].owner != Player::NoPlayer);
+
+			state.grid[row][col] = { owner, PLACEMENT_ORDER[i / 2] };
+
+			Player winner;
+			someoneWon = rules.checkWimCondition(state, winner);
 		}
+
+		if (!someoneWon)
+			break;
 	}
 
-	// Frog moves
-	else if (type == AnimalType::Frog)
+	return state;
+}
+/**
+ * @brief Checks whether any player has WinLength in a row.
+ * @param state Current board state.
+ * @param winner Output winner.
+ * @return true if win detected.
+ */
+template<int Size, int WinLength>
+bool BasicGameplay<Size, WinLength>::checkWimCondition(const State& state, Player& winner)
+{
+	const Lines& lines = LINES<Size, WinLength>;
+
+	std::uint64_t player1Bits, player2Bits;
+	packBoard(state, Player::Player1, player1Bits, player2Bits);
+
+	// Horizontal, vertical and both diagonals all come from the same table
+	for (int line = 0; line < Lines::COUNT; ++line)
 	{
-		// Normal 1-step moves
-		for (auto& direction : DIR8)
+		if ((player1Bits & lines.mask[line]) == lines.mask[line])
 		{
-			int neighbourRow = row + direction[0];
-			int neighbourCol = col + direction[1];
-			if (isValidPosition(neighbourRow, neighbourCol) && state.grid[neighbourRow][neighbourCol].owner == Player::NoPlayer)
-			{
-				moves.push_back({ row, col, neighbourRow, neighbourCol });
-			}
+			winner = Player::Player1;
+			return true;
 		}
-
-		// Long jumps
-		for (auto& direction : DIR8)
+		if ((player2Bits & lines.mask[line]) == lines.mask[line])
 		{
-			int neighbourRow = row + direction[0];
-			int neighbourCol = col + direction[1];
-
-			// Jump over occupied pieces; while within bounds and next cell is occupied
-			while (neighbourRow >= 0 && neighbourRow < BOARD_SIZE && neighbourCol >= 0 && neighbourCol < BOARD_SIZE &&
-				state.grid[neighbourRow][neighbourCol].owner != Player::NoPlayer)
-			{
-				neighbourRow += direction[0];
-				neighbourCol += direction[1];
-			}
-
-			// if we land on an empty cell, it's a valid move
-			if (neighbourRow >= 0 && neighbourRow < BOARD_SIZE && neighbourCol >= 0 && neighbourCol < BOARD_SIZE &&
-				state.grid[neighbourRow][neighbourCol].owner == Player::NoPlayer)
-			{
-				moves.push_back({ row, col, neighbourRow, neighbourCol });
-			}
+			winner = Player::Player2;
+			return true;
 		}
 	}
 
-	return moves;
+	return false;
+}
+
+
+/**
+ * @brief Returns all valid moves for the piece at (row, col).
+ */
+template<int Size, int WinLength>
+std::vector<Move> BasicGameplay<Size, WinLength>::getValidMovesForPiece(int row, int col, const State& state)
+{
+	MoveList moves;
+	getValidMovesForPiece(row, col, state, moves);
+
+	return std::vector<Move>(moves.begin(), moves.end());
 }
+/**
+ * @brief Fills moves with the valid moves for the piece at (row, col).
+ */
+template<int Size, int WinLength>
+void BasicGameplay<Size, WinLength>::getValidMovesForPiece(int row, int col, const State& state, MoveList& moves)
+{
+	moves.clear();
+
+	Player owner = state.grid[row][col].owner;
+	if (owner == Player::NoPlayer)
+		return;
+
+	std::uint64_t playerBits, opponentBits;
+	packBoard(state, owner, playerBits, opponentBits);
+
+	MoveRules<Size>::addPieceMoves(row, col, state.grid[row][col].type, playerBits | opponentBits, moves);
+}
+
+// The engine is compiled once per supported board; add a line here to support another size
+template class BasicGameplay<5, 4>;
+template class BasicGameplay<6, 4>;
+template class BasicGameplay<7, 4>;
+template class BasicGameplay<8, 4>;
@@ -1,100 +1,278 @@
 ﻿#pragma once
-#include <SFML/Graphics.hpp>
-#include "Animal.h"
-#include "Board.h"
+#include "GameTypes.h"
+#include "MoveRules.h"
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <limits>
+#include <random>
+#include <cstdint>
+#include <string>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 /**
  * @file Gameplay.h
  * @brief Contains AI logic, board evaluation, move generation and minimax.
  */
 
 /**
- * @struct Move
- * @brief Represents a move from one board coordinate to another.
+ * @struct BasicBoardstate
+ * @brief Represents the full internal board state used by AI.
+ *
+ * Contains a grid of PieceState and the current player's turn.
+ * @tparam Size Cells per side, fixed at compile time so loops over the grid unroll.
  */
+template<int Size>
+struct BasicBoardstate {
+	static const int SIZE = Size;
 
-struct Move {
-	int row1, col1;
-	int row2, col2;
+	PieceState grid[Size][Size];
+	Player currentPlayer;
 
-	// Constructor for easy Move creation; we can use this to represent invalid moves or no-move
-	Move() : row1(-1), col1(-1), row2(-1), col2(-1) {}
-	Move(int r1, int c1, int r2, int c2) : row1(r1), col1(c1), row2(r2), col2(c2) {}
+	// Constructor
+	BasicBoardstate() : currentPlayer(Player::NoPlayer) {}
 
-	// Check if this is a valid move
-	bool isValid() const {
-		return row1 >= 0 && col1 >= 0 && row2 >= 0 && col2 >= 0;
+	/**
+	 * @brief Empties every cell and sets the player to move.
+	 */
+	void clear(Player player)
+	{
+		for (int row = 0; row < Size; ++row)
+		{
+			for (int col = 0; col < Size; ++col)
+			{
+				grid[row][col] = { Player::NoPlayer, AnimalType::NoType };
+			}
+		}
+
+		currentPlayer = player;
+	}
+
+	// Copy constructor to duplicate board state
+	BasicBoardstate(const PieceState sourceGrid[Size][Size], Player player)
+	{
+		for (int row = 0; row < Size; ++row)
+		{
+			for (int col = 0; col < Size; ++col)
+			{
+				grid[row][col] = sourceGrid[row][col];
+			}
+		}
+
+		currentPlayer = player;
 	}
 };
 
+/// The board the game is played on.
+using Boardstate = BasicBoardstate<BOARD_SIZE>;
+
+/**
+ * @brief Counts the set bits of a board mask.
+ */
+inline int countBits(std::uint64_t bits)
+{
+#if defined(__GNUC__) && defined(__POPCNT__)
+	return __builtin_popcountll(bits);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX2__)
+	return static_cast<int>(__popcnt64(bits));
+#else
+	bits = bits - ((bits >> 1) & 0x5555555555555555ull);
+	bits = (bits & 0x3333333333333333ull) + ((bits >> 2) & 0x3333333333333333ull);
+	return static_cast<int>((((bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0Full) * 0x0101010101010101ull) >> 56);
+#endif
+}
+
 /**
- * @struct PieceState
- * @brief Representation of a board piece used for AI calculations.
- * Contains only owner and type.
+ * @struct LineTable
+ * @brief Every line of WinLength cells on a Size x Size board (rows, columns, both diagonals).
+ *
+ * Built at compile time by makeLineTable. Each line is a bit mask over a packed
+ * board, so evaluation and win checks are a mask test per line instead of four
+ * hand-written loops with 5x5 offsets baked in.
  */
+template<int Size, int WinLength>
+struct LineTable {
+	static_assert(WinLength >= 2 && WinLength <= Size, "A line must fit on the board");
+	static_assert(Size <= 8, "Line masks are 64 bit");
 
-// No rendering information, otherwise performance will be TERRIBLE
-struct PieceState {
-	Player owner;
-	AnimalType type;
+	static const int SPAN = Size - WinLength + 1; ///< Start positions along one axis
+	static const int COUNT = 2 * Size * SPAN + 2 * SPAN * SPAN;
+
+	std::uint64_t mask[COUNT]{};       ///< Bit (row * Size + col) for every cell in the line
+	std::uint64_t centerMask{ 0 };     ///< Every cell off the edge of the board
 };
 
 /**
- * @struct Boardstate
- * @brief Represents the full internal board state used by AI.
- *
- * Contains a grid of PieceState and the current player's turn.
+ * @brief Builds the LineTable for a board size and win length.
  */
-struct Boardstate {
-	PieceState grid[BOARD_SIZE][BOARD_SIZE];
-	Player currentPlayer;
+template<int Size, int WinLength>
+constexpr LineTable<Size, WinLength> makeLineTable()
+{
+	LineTable<Size, WinLength> table{};
 
-	// Constructor
-	Boardstate() : currentPlayer(Player::NoPlayer) {}
+	// Horizontal, vertical, diagonal (top-left to bottom-right), diagonal (bottom-left to top-right)
+	const int steps[4][2] = { {0, 1}, {1, 0}, {1, 1}, {-1, 1} };
 
-	// Copy constructor to duplicate board state
-	Boardstate(const PieceState sourceGrid[BOARD_SIZE][BOARD_SIZE], Player player)
+	int line = 0;
+	for (int direction = 0; direction < 4; ++direction)
 	{
-		for (int row = 0; row < BOARD_SIZE; ++row)
+		for (int row = 0; row < Size; ++row)
 		{
-			for (int col = 0; col < BOARD_SIZE; ++col)
+			for (int col = 0; col < Size; ++col)
 			{
-				grid[row][col] = sourceGrid[row][col];
+				int lastRow = row + steps[direction][0] * (WinLength - 1);
+				int lastCol = col + steps[direction][1] * (WinLength - 1);
+				if (lastRow < 0 || lastRow >= Size || lastCol >= Size)
+					continue;
+
+				for (int i = 0; i < WinLength; ++i)
+				{
+					int cell = (row + steps[direction][0] * i) * Size + col + steps[direction][1] * i;
+					table.mask[line] |= std::uint64_t(1) << cell;
+				}
+				line++;
 			}
 		}
-
-		currentPlayer = player;
 	}
-};
+
+	for (int row = 1; row < Size - 1; ++row)
+		for (int col = 1; col < Size - 1; ++col)
+			table.centerMask |= std::uint64_t(1) << (row * Size + col);
+
+	return table;
+}
+
+/// One table per board size / win length, shared by everything that needs it.
+template<int Size, int WinLength>
+inline constexpr LineTable<Size, WinLength> LINES = makeLineTable<Size, WinLength>();
+
+class NeuralEvaluator;
+class TranspositionTable;
 
 static const int UNLIMITED_POWER = 999999; ///< Infinity value for evaluation
+static const int DRAW_SCORE = 0;           ///< Score of a repeated position
+static const int MAX_SEARCH_DEPTH = 64;    ///< Deepest iteration any caller runs, in plies
+static const int MAX_THREAT_DEPTH = 8;     ///< Most threats setThreatDepth accepts
+
+/**
+ * @struct DrawRules
+ * @brief When a game in the movement phase is adjudicated as a draw.
+ */
+struct DrawRules {
+	int repetitions{ 3 };          ///< The same position with the same side to move this often, 0 to never
+	int maxMovementPlies{ 200 };   ///< Board moves in the whole game, 0 for no limit
+
+	/**
+	 * @brief Whether the game is drawn in the position keys ends with.
+	 * @param keys positionKey of every position of the game so far, the current one last.
+	 * @param movementPlies Board moves played so far.
+	 */
+	bool isDraw(const std::vector<std::uint64_t>& keys, int movementPlies) const;
+};
+
+/**
+ * @struct EvalWeights
+ * @brief Weights of the evaluateBoard terms. The defaults are the original hand-picked values,
+ *        a tuned set can be loaded from a text file of "name value" lines.
+ */
+struct EvalWeights {
+	int threat{ 100 };          ///< Per AI line one piece short of a win (can win next turn)
+	int opponentThreat{ 90 };   ///< Per opponent line one piece short of a win
+	int build{ 30 };            ///< Per AI line two pieces short of a win
+	int opponentBuild{ 25 };    ///< Per opponent line two pieces short of a win
+	int material{ 10 };         ///< Per piece on the board
+	int center{ 5 };            ///< Extra per piece off the edge
+
+	static const int COUNT = 6;
+
+	/**
+	 * @brief Weight by index, in the order the members are declared.
+	 */
+	int& operator[](int index);
+	int operator[](int index) const;
+
+	/**
+	 * @brief Name used in the weights file.
+	 */
+	static const char* name(int index);
+
+	/**
+	 * @brief Reads a weights file. Names that are missing keep their current value.
+	 * @return false if the file could not be opened.
+	 */
+	bool load(const std::string& path);
+
+	/**
+	 * @brief Writes every weight as a "name value" line.
+	 */
+	bool save(const std::string& path) const;
+};
+
 /**
- * @class Gameplay
+ * @struct SearchLimits
+ * @brief When chooseBestMove has to give up before finishing its depth.
+ */
+struct SearchLimits {
+	std::uint64_t nodes{ 0 };                                                        ///< Nodes per search, 0 for no limit
+	std::chrono::steady_clock::time_point deadline{ std::chrono::steady_clock::time_point::max() };
+	const std::atomic<bool>* stop{ nullptr };                                       ///< Set by another thread to stop at once
+};
+
+/**
+ * @struct ScoredMove
+ * @brief A root move and its search score, from the mover's point of view.
+ */
+struct ScoredMove {
+	Move move;
+	int score;
+};
+
+/**
+ * @class BasicGameplay
  * @brief Handles all AI logic: minimax, evaluation, move generation, win checks.
+ * @tparam Size Cells per side.
+ * @tparam WinLength Pieces in a row needed to win.
+ *
+ * Instantiated in Gameplay.cpp for 5x5, 6x6, 7x7 and 8x8 boards with four in a row.
  */
-class Gameplay
+template<int Size, int WinLength>
+class BasicGameplay
 {
 public:
+	using State = BasicBoardstate<Size>;
+	using Lines = LineTable<Size, WinLength>;
+
     /**
      * @brief Constructs a Gameplay object with default AI parameters.
      */
-	Gameplay();
+	BasicGameplay();
 	/**
 	 * @brief Computes the best move for the current player using minimax.
 	 * @param state Current board state.
 	 * @param depth Search depth for minimax.
 	 * @return The best move found.
 	 */
-	Move chooseBestMove(const Boardstate& state, int depth);
+	Move chooseBestMove(const State& state, int depth);
+	/**
+	 * @brief Searches one move as chooseBestMove searches each of its root moves, so its
+	 *        score is on the same scale as getLastScore: from the mover's point of view,
+	 *        evaluated by the mover at the same horizon.
+	 * @param state Position the move is played in.
+	 * @param move A legal move in state.
+	 * @param depth Search depth, as passed to chooseBestMove.
+	 * @return Score of the move, meaningless if wasStopped() is true afterwards.
+	 */
+	int scoreMove(const State& state, const Move& move, int depth);
 
 	/**
 	 * @brief Checks if the board contains a win condition.
 	 * @param state The current board state.
 	 * @param winner Output parameter storing the winning player.
-	 * @return true if a player has achieved four in a row.
+	 * @return true if a player has WinLength in a row.
 	 */
-	bool checkWimCondition(const Boardstate& state, Player& winner);
+	bool checkWimCondition(const State& state, Player& winner);
 	/**
 	 * @brief Gets all valid moves for a piece located at (row, col).
 	 * @param row Piece row.
@@ -103,15 +281,206 @@ public:
 	 * @return List of valid moves.
 	 */
 
-	std::vector<Move> getValidMovesForPiece(int row, int col, const Boardstate& state);
+	std::vector<Move> getValidMovesForPiece(int row, int col, const State& state);
+
+	/**
+	 * @brief Allocation-free version of getValidMovesForPiece used by the UI.
+	 * @param moves Cleared, then filled with the moves of the piece.
+	 */
+	void getValidMovesForPiece(int row, int col, const State& state, MoveList& moves);
+	/**
+	 * @brief Heuristic board evaluation used when minimax depth ends.
+	 * @param state Current board state.
+	 * @param maximizingPlayer AI-controlled player.
+	 * @return Numeric score (higher = better for AI).
+	 */
+	int evaluateBoard(const State& state, Player maximizingPlayer);
+
+	/**
+	 * @brief Lines where the player is one piece short of a win with the last cell empty.
+	 */
+	int countThreats(const State& state, Player player) const;
+
+	/**
+	 * @brief Generates all legal moves for the current player.
+	 */
+	std::vector<Move> generateMoves(const State& state);
+
+	/**
+	 * @brief Allocation-free version of generateMoves used by the search.
+	 * @param state Current board state.
+	 * @param moves Cleared, then filled with every legal move.
+	 */
+	void generateMoves(const State& state, MoveList& moves);
+
+	/**
+	 * @brief Applies a move to a board and returns the resulting state.
+	 */
+	State makeMove(const State& state, const Move& move);
+
+	/**
+	 * @brief Applies a move in place. Also updates the attached network's accumulator.
+	 */
+	void doMove(State& state, const Move& move);
+
+	/**
+	 * @brief Takes back a move made with doMove.
+	 */
+	void undoMove(State& state, const Move& move);
+
 	/**
-	 * @brief Converts an Animal instance into a PieceState.
+	 * @brief Replaces the evaluateBoard weights.
 	 */
-	static PieceState toPieceState(const Animal& animal);
+	void setWeights(const EvalWeights& weights);
+
+	/**
+	 * @brief Current evaluateBoard weights.
+	 */
+	const EvalWeights& getWeights() const;
+
+	/**
+	 * @brief Score of the move returned by the last chooseBestMove, from the mover's point of view.
+	 */
+	int getLastScore() const;
+
+	/**
+	 * @brief Turns the per-move search log on or off (on by default).
+	 */
+	void setVerbose(bool verbose);
+
+	/**
+	 * @brief Seeds the random engine that picks between equally scored root moves.
+	 *        The same seed, position and settings always give the same move and node count.
+	 */
+	void setSeed(unsigned int seed);
+
+	/**
+	 * @brief Uses a neural network instead of evaluateBoard at the search leaves.
+	 * @param network Loaded network, or nullptr to go back to the heuristic.
+	 */
+	void setNeuralEvaluator(NeuralEvaluator* network);
+
+	/**
+	 * @brief Lets the search reuse results for positions it reaches more than once.
+	 * @param table Table owned by the caller, or nullptr to search without one. Entries
+	 *        are only valid for one evaluator, clear the table after changing weights or network.
+	 */
+	void setTranspositionTable(TranspositionTable* table);
+
+	/**
+	 * @brief Zobrist key of the pieces and the side to move.
+	 */
+	static std::uint64_t positionKey(const State& state);
+
+	/**
+	 * @brief Limits every following chooseBestMove. The default limits never stop a search.
+	 */
+	void setSearchLimits(const SearchLimits& limits);
+
+	/**
+	 * @brief Positions the game went through before the one to search. The search scores
+	 *        any position that is in here, or earlier on its own path, as DRAW_SCORE.
+	 * @param keys positionKey of each position, oldest first. Including the current one is fine.
+	 */
+	void setGameHistory(const std::vector<std::uint64_t>& keys);
+
+	/**
+	 * @brief True if the last chooseBestMove hit a limit. Its move is then the best of the
+	 *        root moves searched to the end, or an invalid Move if there were none.
+	 */
+	bool wasStopped() const;
+
+	/**
+	 * @brief Positions the last chooseBestMove visited.
+	 */
+	std::uint64_t getNodesEvaluated() const;
+
+	/**
+	 * @brief Best line after the last chooseBestMove, read back from the transposition table.
+	 * @param state Position that was searched.
+	 * @param first Move chooseBestMove returned.
+	 * @param maxLength Longest line to return.
+	 * @return The moves, first included. Just first when no table is attached.
+	 */
+	std::vector<Move> getPrincipalVariation(const State& state, const Move& first, int maxLength);
+
+	/**
+	 * @brief Threat-space search: a forced win for the side to move made only of threats,
+	 *        moves after which a line is one piece short and the opponent has to stop it.
+	 *        Only those moves and the replies that stop them are searched, so a win a few
+	 *        threats deep is found long before alpha-beta would get there.
+	 * @param maxThreats Threats allowed before the one that cannot be stopped, 0 for a win in one.
+	 * @param move Set to the first move of the win, only when there is one.
+	 * @return true if the side to move wins by force.
+	 */
+	bool findThreatWin(const State& state, int maxThreats, Move& move);
+
+	/**
+	 * @brief Threats the pre-check before every search may use (2 by default), 0 turns it off.
+	 *        Clamped to MAX_THREAT_DEPTH.
+	 *        A single line sliced search and chooseBestMove play a threat win without searching.
+	 */
+	void setThreatDepth(int maxThreats);
+
+	/**
+	 * @brief Multi-PV search: the best few moves with their scores, from one search.
+	 *
+	 * Root moves are searched against the score of the lines-th best move so far rather
+	 * than the best, so a move that cannot make the list is cut off as cheaply as in
+	 * chooseBestMove, and every line shares the one table.
+	 * @param lines Moves wanted, 1 searches the same nodes as chooseBestMove.
+	 * @return Up to lines moves, best first. Fewer if there are fewer legal moves.
+	 */
+	std::vector<ScoredMove> chooseBestMoves(const State& state, int depth, int lines);
+
+	/**
+	 * @brief Starts a chooseBestMove that runs a slice at a time, for a caller that cannot
+	 *        block (a game loop on one core). Nothing else may search on this object until
+	 *        continueSearch returns true or abortSearch is called.
+	 * @param lines Moves to score exactly, as in chooseBestMoves.
+	 */
+	void beginSearch(const State& state, int depth, int lines = 1);
+
+	/**
+	 * @brief Searches until the search is finished or the slice is used up. The search path,
+	 *        move lists and bounds are kept between slices, so the nodes visited and the
+	 *        move chosen are the same as one chooseBestMove call.
+	 * @param nodes Nodes in this slice, 0 for no limit.
+	 * @param deadline End of this slice, only looked at after the first MIN_SLICE_NODES nodes.
+	 * @return true once the search is finished, its move is then in getSearchResult.
+	 */
+	bool continueSearch(std::uint64_t nodes, std::chrono::steady_clock::time_point deadline);
+
+	/**
+	 * @brief True between beginSearch and the end of the search.
+	 */
+	bool isSearching() const;
+
+	/**
+	 * @brief Drops an unfinished search. Does nothing if none is running.
+	 */
+	void abortSearch();
+
 	/**
-	* @brief Converts a PieceState into an Animal instance.
-	*/
-	static Animal toAnimal(const PieceState& pieceState);
+	 * @brief Move of the last search finished by continueSearch, invalid if there was none.
+	 */
+	Move getSearchResult() const;
+
+	/**
+	 * @brief Best moves of the last search finished by continueSearch, best first.
+	 */
+	std::vector<ScoredMove> getSearchLines() const;
+
+	/// Nodes every slice searches before it looks at the clock, so each one gets somewhere.
+	static const int MIN_SLICE_NODES = 256;
+
+	/**
+	 * @brief Builds a movement phase start position by placing both players' pieces at random,
+	 *        the same way the AI places pieces in Game. Placements that produce a win are retried.
+	 * @param rng Random engine to draw the cells from.
+	 * @return Board with all ten pieces placed and Player 1 to move.
+	 */
+	static State randomStartingPosition(std::mt19937& rng);
 
 private:
 	/**
@@ -123,52 +492,170 @@ private:
 	 * @param beta Beta pruning value.
 	 * @return The evaluated score.
 	 */
-	int miniMax(const Boardstate& state, int depth, bool isMaximizing, int alpha, int beta);
+	int miniMax(State& state, int depth, bool isMaximizing, int alpha, int beta);
 
 	/**
-	 * @brief Heuristic board evaluation used when minimax depth ends.
-	 * @param state Current board state.
-	 * @param maximizingPlayer AI-controlled player.
-	 * @return Numeric score (higher = better for AI).
+	 * @brief Builds one occupancy bit mask per side, bit (row * Size + col).
+	 * @param state Board to pack.
+	 * @param player Side whose pieces go in playerBits; everyone else goes in opponentBits.
 	 */
-	int evaluateBoard(const Boardstate& state, Player maximizingPlayer);
+	void packBoard(const State& state, Player player, std::uint64_t& playerBits, std::uint64_t& opponentBits) const;
+
 	/**
-	 * @brief Calculates threat patterns (3 in a row with one empty).
+	 * @brief Counts lines holding exactly `pieces` of the player's pieces with every other cell empty.
+	 *        WinLength - 1 pieces is a threat (win next turn), WinLength - 2 is a line being built.
 	 */
-	int evaluateThreeInARow(const Boardstate& state, Player player);
+	int countOpenLines(std::uint64_t playerBits, std::uint64_t opponentBits, int pieces) const;
+
 	/**
-	 * @brief Checks four tiles for a potential threat.
+	 * @brief XORs a move into m_hash. Doing it twice takes it back out.
+	 * @param piece The piece being moved.
 	 */
-	int checkForThreeInARow(Player p1, Player p2, Player p3, Player p4, Player player);
+	void updateHash(const Move& move, const PieceState& piece);
 
 	/**
-	 * @brief Calculates patterns of two in a row with two empty.
+	 * @brief Checks the limits, cheaply: the clock and stop flag only every 1024 nodes.
 	 */
-	int evaluateTwoInARow(const Boardstate& state, Player player);
+	bool limitReached();
+
 	/**
-	 * @brief Checks four tiles for a potential two-in-a-row.
+	 * @brief Moves the table's best move for this position to the front of the list, if it is in it.
 	 */
-	int checkForTwoInARow(Player p1, Player p2, Player p3, Player p4, Player player);
+	void orderTableMove(std::uint16_t packed, MoveList& moves) const;
 
 	/**
-	 * @brief Generates all legal moves for the current player.
+	 * @brief Adds a position to the game history and search path stack.
 	 */
-	std::vector<Move> generateMoves(const Boardstate& state);
+	void pushKey(std::uint64_t key);
 
 	/**
-	 * @brief Applies a move to a board and returns the resulting state.
+	 * @brief Removes the newest position of the stack.
+	 */
+	void popKey();
+
+	/**
+	 * @brief True if m_hash is already on the stack.
+	 */
+	bool isRepetition() const;
+
+	/**
+	 * @brief True if the side to move can complete a line with its next move.
+	 *        Only moves onto the empty cell of a line one piece short are tried.
+	 * @param move Set to the winning move if not nullptr.
+	 */
+	bool canWinNow(const State& state, Move* move);
+
+	/**
+	 * @brief findThreatWin below the root.
+	 * @param first Set to the first move of the win if not nullptr.
+	 */
+	bool threatWin(const State& state, int threats, Move* first);
+
+	/**
+	 * @struct SearchFrame
+	 * @brief One miniMax call of a sliced search: its moves, how far through them it is and its bounds.
 	 */
-	Boardstate makeMove(const Boardstate& state, const Move& move);
+	struct SearchFrame {
+		MoveList moves;
+		int next;          ///< Index of the move to search next
+		int depth;
+		bool maximizing;
+		int alpha;
+		int beta;
+		int alphaOrig;     ///< Bounds the node was entered with, to pick its table bound
+		int betaOrig;
+		int best;
+		Move bestMove;
+		std::uint64_t key; ///< Table key, 0 without a table
+	};
 
 	/**
-	 * @brief Checks whether a board coordinate is valid.
+	 * @brief miniMax up to its move loop, on m_searchState.
+	 * @return true if the node was scored without searching its moves, the score is then in score.
+	 *         Otherwise its frame was pushed.
 	 */
-	bool isValidPosition(int row, int col) const;
+	bool openNode(int depth, bool isMaximizing, int alpha, int beta, int& score);
+
+	/**
+	 * @brief miniMax after its move loop: pops the top frame and stores its result.
+	 * @return The node's score.
+	 */
+	int closeNode();
+
+	/**
+	 * @brief Takes back the top frame's current move and counts its score, as miniMax's loop does.
+	 */
+	void foldScore(int score);
+
+	/**
+	 * @brief chooseBestMove after its move loop: picks among the best root moves.
+	 */
+	void finishSearch();
+
 
 	// The player that the AI is trying to maximize
 	Player m_maximizingPlayer;
 
 	// Counter for debugging - tracks how many board states the AI evaluated before choosing a move
-	int m_nodesEvaluated;
+	std::uint64_t m_nodesEvaluated;
+
+	// Leaf evaluation network, nullptr to use evaluateBoard
+	NeuralEvaluator* m_network;
+
+	// Weights of the evaluateBoard terms
+	EvalWeights m_weights;
+
+	// Score of the last chosen move
+	int m_lastScore;
+
+	// Print the search log to the console
+	bool m_verbose;
+
+	// Breaks ties between the best root moves, one per engine so threads do not share it
+	std::mt19937 m_rng;
+
+	// Search results shared between chooseBestMove calls, nullptr to search without
+	TranspositionTable* m_table;
+
+	// positionKey of the search board, kept up to date by doMove and undoMove
+	std::uint64_t m_hash;
+
+	// When to give up a search
+	SearchLimits m_limits;
+
+	// A limit was hit, every node on the way back up returns at once
+	bool m_stopped;
+
+	// Game history followed by the positions on the current search path
+	std::vector<std::uint64_t> m_keys;
+
+	// How many keys on the stack share each value of their low 12 bits, most lookups stop here
+	std::array<std::uint16_t, 4096> m_keyFilter;
+
+	// Threats the threat-space pre-check may use, 0 for none
+	int m_threatDepth;
+
+	// Search path of a sliced search, the root first. Empty when none is running.
+	std::vector<SearchFrame> m_frames;
+
+	// Board of a sliced search, with the moves of m_frames made on it
+	State m_searchState;
+
+	// Root moves of a sliced search sharing the best score so far
+	std::vector<Move> m_rootBest;
+
+	// Every root move searched so far with its score, best first, and how many are wanted
+	std::vector<ScoredMove> m_rootLines;
+	int m_lines;
+
+	// Depth a sliced search was started with, and its table key
+	int m_searchDepth;
+	std::uint64_t m_rootKey;
+
+	// Move of the last finished sliced search
+	Move m_searchResult;
 };
 
+/// The engine for the board the game is played on.
+using Gameplay = BasicGameplay<BOARD_SIZE, WIN_LENGTH>;
+
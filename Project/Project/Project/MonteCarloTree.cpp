@@ -0,0 +1,323 @@
+#include "MonteCarloTree.h"
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+// UCT exploration constant, results are scaled to [0, 1]
+static const double EXPLORATION = 1.4;
+
+/**
+ * @brief Constructs the search with one worker per hardware thread.
+ */
+MonteCarloTree::MonteCarloTree() : m_threads(std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+/**
+ * @brief Sets the number of worker threads (at least one).
+ */
+void MonteCarloTree::setThreads(int threads)
+{
+	m_threads = std::max(1, threads);
+}
+
+/**
+ * @brief Sets the virtual loss added per node while a playout is in flight.
+ */
+void MonteCarloTree::setVirtualLoss(int virtualLoss)
+{
+	m_virtualLoss = std::max(0, virtualLoss);
+}
+
+/**
+ * @brief Seeds the playout random engines.
+ */
+void MonteCarloTree::setSeed(unsigned int seed)
+{
+	m_seed = seed;
+}
+
+/**
+ * @brief Playouts completed by the last search.
+ */
+int MonteCarloTree::getLastPlayouts() const
+{
+	return m_lastPlayouts;
+}
+
+/**
+ * @brief Runs all worker threads on a shared tree for the given wall time.
+ * @param state Current board state.
+ * @param seconds Time budget.
+ * @return Most visited root move.
+ */
+Move MonteCarloTree::chooseBestMove(const Boardstate& state, float seconds)
+{
+	Gameplay rules;
+	MoveList moves;
+	rules.generateMoves(state, moves);
+	if (moves.empty()) {
+		return Move();
+	}
+
+	MCTSNode root;
+	root.mover = (state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+
+	m_stop = false;
+	m_playouts = 0;
+
+	std::vector<std::thread> workers;
+	for (int i = 0; i < m_threads; ++i) {
+		workers.emplace_back(&MonteCarloTree::worker, this, &root, std::cref(state), m_seed + i * 7919u);
+	}
+
+	std::this_thread::sleep_for(std::chrono::duration<float>(seconds));
+	m_stop = true;
+
+	for (std::thread& thread : workers) {
+		thread.join();
+	}
+
+	m_lastPlayouts = m_playouts;
+	// Next search uses different playouts
+	m_seed = m_seed * 1664525u + 1013904223u;
+
+	// Most visited is more robust than best average
+	Move bestMove;
+	int mostVisits = -1;
+	for (const auto& child : root.children) {
+		if (child->visits > mostVisits) {
+			mostVisits = child->visits;
+			bestMove = child->move;
+		}
+	}
+
+	return bestMove;
+}
+
+/**
+ * @brief One worker thread. Every iteration walks from the root to a leaf, expands it,
+ *        runs a random playout and backs the result up the path.
+ */
+void MonteCarloTree::worker(MCTSNode* root, const Boardstate& rootState, unsigned int seed)
+{
+	Gameplay rules;
+	std::mt19937 rng(seed);
+	std::vector<MCTSNode*> path;
+
+	while (!m_stop.load(std::memory_order_relaxed))
+	{
+		path.clear();
+		Boardstate state = rootState;
+		MCTSNode* node = root;
+		Player winner = Player::NoPlayer;
+		bool gameOver = false;
+
+		// Virtual loss: count this visit straight away, its result is added on the way back up
+		node->visits.fetch_add(m_virtualLoss, std::memory_order_relaxed);
+		path.push_back(node);
+
+		// Selection
+		while (!gameOver)
+		{
+			bool wasExpanded = node->expanded.load(std::memory_order_acquire);
+			if (!wasExpanded) {
+				expand(node, state, rules);
+			}
+			if (node->children.empty())
+				break;
+
+			node = selectChild(node);
+			state = rules.makeMove(state, node->move);
+			node->visits.fetch_add(m_virtualLoss, std::memory_order_relaxed);
+			path.push_back(node);
+
+			gameOver = rules.checkWimCondition(state, winner);
+
+			// One new node per iteration: play out from the child of a freshly expanded leaf
+			if (!wasExpanded)
+				break;
+		}
+
+		// Simulation
+		if (!gameOver) {
+			winner = playout(state, rules, rng);
+		}
+
+		// Backpropagation: swap the virtual loss for the real result
+		for (MCTSNode* visited : path)
+		{
+			int result = 1;
+			if (winner != Player::NoPlayer) {
+				result = (winner == visited->mover) ? 2 : 0;
+			}
+			visited->value.fetch_add(result, std::memory_order_relaxed);
+			visited->visits.fetch_add(1 - m_virtualLoss, std::memory_order_relaxed);
+		}
+
+		m_playouts.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+/**
+ * @brief UCT selection. Unvisited children are taken first; in-flight virtual
+ *        losses lower a child's average so other threads avoid it.
+ */
+MCTSNode* MonteCarloTree::selectChild(MCTSNode* node) const
+{
+	int parentVisits = std::max(1, node->visits.load(std::memory_order_relaxed));
+	double logParent = std::log(static_cast<double>(parentVisits));
+
+	MCTSNode* bestChild = nullptr;
+	double bestScore = -1.0;
+
+	for (const auto& child : node->children)
+	{
+		int visits = child->visits.load(std::memory_order_relaxed);
+		if (visits == 0) {
+			return child.get();
+		}
+
+		double average = child->value.load(std::memory_order_relaxed) / (2.0 * visits);
+		double score = average + EXPLORATION * std::sqrt(logParent / visits);
+
+		if (score > bestScore) {
+			bestScore = score;
+			bestChild = child.get();
+		}
+	}
+
+	return bestChild;
+}
+
+/**
+ * @brief Adds one child per legal move. The first thread to arrive builds the list,
+ *        any others wait on the lock and then use it.
+ */
+void MonteCarloTree::expand(MCTSNode* node, const Boardstate& state, Gameplay& rules) const
+{
+	std::lock_guard<std::mutex> lock(node->expandLock);
+	if (node->expanded.load(std::memory_order_relaxed))
+		return;
+
+	MoveList moves;
+	rules.generateMoves(state, moves);
+
+	for (const Move& move : moves)
+	{
+		auto child = std::make_unique<MCTSNode>();
+		child->move = move;
+		child->mover = state.currentPlayer;
+		child->parent = node;
+		node->children.push_back(std::move(child));
+	}
+
+	node->expanded.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Random playout from state.
+ */
+Player MonteCarloTree::playout(Boardstate state, Gameplay& rules, std::mt19937& rng) const
+{
+	Player winner = Player::NoPlayer;
+	MoveList moves;
+
+	for (int ply = 0; ply < MAX_PLAYOUT_PLIES; ++ply)
+	{
+		rules.generateMoves(state, moves);
+		if (moves.empty())
+			break;
+
+		rules.doMove(state, moves[rng() % moves.size()]);
+
+		if (rules.checkWimCondition(state, winner))
+			return winner;
+	}
+
+	return Player::NoPlayer;
+}
+
+/**
+ * @brief Measures playouts/sec on a fixed position for growing thread counts.
+ */
+void MonteCarloTree::runThroughputBenchmark(float secondsPerRun, int maxThreads)
+{
+	std::mt19937 rng(2024);
+	Boardstate position = Gameplay::randomStartingPosition(rng);
+
+	std::cout << "threads    playouts    playouts/sec    per thread\n";
+
+	int threads = 1;
+	while (true)
+	{
+		MonteCarloTree search;
+		search.setThreads(threads);
+		search.chooseBestMove(position, secondsPerRun);
+
+		double rate = search.getLastPlayouts() / secondsPerRun;
+		std::cout << std::setw(7) << threads
+			<< std::setw(12) << search.getLastPlayouts()
+			<< std::setw(16) << static_cast<long long>(rate)
+			<< std::setw(14) << static_cast<long long>(rate / threads) << "\n";
+
+		if (threads >= maxThreads)
+			break;
+		threads = std::min(threads * 2, maxThreads);
+	}
+}
+
+/**
+ * @brief Parallel search against single-threaded search at equal time per move.
+ *        Colours alternate every game and each game starts from a random placement.
+ */
+void MonteCarloTree::runStrengthMatch(int games, float secondsPerMove, int threads)
+{
+	// Games that go on longer than this are called a draw
+	static const int MAX_GAME_PLIES = 100;
+
+	std::mt19937 rng(7);
+	Gameplay rules;
+	int wins = 0, draws = 0, losses = 0;
+
+	for (int game = 0; game < games; ++game)
+	{
+		Boardstate state = Gameplay::randomStartingPosition(rng);
+
+		MonteCarloTree parallel;
+		parallel.setThreads(threads);
+		parallel.setSeed(game * 2 + 1);
+
+		MonteCarloTree serial;
+		serial.setThreads(1);
+		serial.setSeed(game * 2 + 2);
+
+		Player parallelSide = (game % 2 == 0) ? Player::Player1 : Player::Player2;
+		Player winner = Player::NoPlayer;
+
+		for (int ply = 0; ply < MAX_GAME_PLIES; ++ply)
+		{
+			MonteCarloTree& engine = (state.currentPlayer == parallelSide) ? parallel : serial;
+			Move move = engine.chooseBestMove(state, secondsPerMove);
+			if (!move.isValid())
+				break;
+
+			state = rules.makeMove(state, move);
+			if (rules.checkWimCondition(state, winner))
+				break;
+		}
+
+		if (winner == Player::NoPlayer) draws++;
+		else if (winner == parallelSide) wins++;
+		else losses++;
+
+		std::cout << "Game " << game + 1 << ": "
+			<< (winner == Player::NoPlayer ? "draw" : (winner == parallelSide ? "parallel wins" : "serial wins")) << "\n";
+	}
+
+	double score = games > 0 ? (wins + 0.5 * draws) / games * 100.0 : 0.0;
+	std::cout << threads << " threads vs 1 thread at " << secondsPerMove << "s/move: +"
+		<< wins << " =" << draws << " -" << losses << " (" << score << "%)\n";
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "Gameplay.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <vector>
+/**
+ * @file MonteCarloTree.h
+ * @brief Tree-parallel Monte Carlo Tree Search for the movement phase.
+ */
+
+/**
+ * @struct MCTSNode
+ * @brief One node of the shared search tree.
+ *
+ * Visit and value counters are atomics so every worker thread can descend and
+ * update the same tree without a global lock. Only expansion takes a lock.
+ */
+struct MCTSNode {
+	Move move;                      ///< Move that led to this node (invalid for the root)
+	Player mover{ Player::NoPlayer }; ///< Player who made that move
+	MCTSNode* parent{ nullptr };
+
+	std::vector<std::unique_ptr<MCTSNode>> children;
+	std::atomic<bool> expanded{ false }; ///< Set once children is fully built
+	std::mutex expandLock;
+
+	std::atomic<int> visits{ 0 };   ///< Playouts through this node, including virtual losses in flight
+	std::atomic<int> value{ 0 };    ///< Results in half points (win 2, draw 1, loss 0) for mover
+};
+
+/**
+ * @class MonteCarloTree
+ * @brief Tree-parallel MCTS: several threads share one tree.
+ *
+ * While a thread walks down a path it adds a virtual loss to every node on it,
+ * so the other threads see that path as worse and spread out over the tree
+ * instead of all running playouts through the same line.
+ */
+class MonteCarloTree
+{
+public:
+	/**
+	 * @brief Constructs the search with one thread per hardware core.
+	 */
+	MonteCarloTree();
+
+	/**
+	 * @brief Sets how many worker threads descend the tree.
+	 */
+	void setThreads(int threads);
+
+	/**
+	 * @brief Sets how many visits a thread adds to each node on its path while the playout runs.
+	 */
+	void setVirtualLoss(int virtualLoss);
+
+	/**
+	 * @brief Seeds the per-thread random engines used for playouts.
+	 */
+	void setSeed(unsigned int seed);
+
+	/**
+	 * @brief Runs the search for a fixed wall time and returns the most visited root move.
+	 * @param state Current board state.
+	 * @param seconds Wall time budget.
+	 * @return The chosen move, or an invalid Move if there are no legal moves.
+	 */
+	Move chooseBestMove(const Boardstate& state, float seconds);
+
+	/**
+	 * @brief Number of playouts completed by the last call to chooseBestMove.
+	 */
+	int getLastPlayouts() const;
+
+	/**
+	 * @brief Prints playouts/sec for 1, 2, 4 ... maxThreads threads on the same position.
+	 */
+	static void runThroughputBenchmark(float secondsPerRun, int maxThreads);
+
+	/**
+	 * @brief Plays a match between a multi-threaded and a single-threaded search
+	 *        with the same wall time per move and prints the result.
+	 */
+	static void runStrengthMatch(int games, float secondsPerMove, int threads);
+
+private:
+	/**
+	 * @brief Worker loop: select, expand, play out and back up until the deadline.
+	 */
+	void worker(MCTSNode* root, const Boardstate& rootState, unsigned int seed);
+
+	/**
+	 * @brief Picks the child with the best UCT score, counting virtual losses.
+	 */
+	MCTSNode* selectChild(MCTSNode* node) const;
+
+	/**
+	 * @brief Creates one child per legal move. Safe to call from several threads.
+	 */
+	void expand(MCTSNode* node, const Boardstate& state, Gameplay& rules) const;
+
+	/**
+	 * @brief Plays random moves until someone wins or the ply limit is hit.
+	 * @return The winner, or NoPlayer for a draw.
+	 */
+	Player playout(Boardstate state, Gameplay& rules, std::mt19937& rng) const;
+
+	int m_threads;
+	int m_virtualLoss{ 3 };
+	unsigned int m_seed{ 1 };
+
+	std::atomic<bool> m_stop{ false };
+	std::atomic<int> m_playouts{ 0 };
+	int m_lastPlayouts{ 0 };
+
+	static const int MAX_PLAYOUT_PLIES = 40; ///< Playouts longer than this count as a draw
+};
@@ -0,0 +1,142 @@
+#pragma once
+#include "GameTypes.h"
+#include <cstdint>
+/**
+ * @file MoveRules.h
+ * @brief The one movement rules core, used by the AI search and by the UI highlights.
+ */
+
+/**
+ * @struct MoveList
+ * @brief Fixed-capacity move list, filled without touching the heap.
+ */
+struct MoveList {
+	static const int CAPACITY = 64; ///< More than five pieces can ever have (frog 16, snake 8, donkeys 4 each)
+
+	Move moves[CAPACITY];
+	int count{ 0 };
+
+	void clear() { count = 0; }
+	void push_back(const Move& move) { moves[count++] = move; }
+	int size() const { return count; }
+	bool empty() const { return count == 0; }
+
+	const Move& operator[](int index) const { return moves[index]; }
+	const Move* begin() const { return moves; }
+	const Move* end() const { return moves + count; }
+};
+
+/**
+ * @struct RayTable
+ * @brief For every cell and direction, the cells along that direction up to the edge.
+ *
+ * Directions are in the order the rules have always used: the four cardinal
+ * directions first (down, up, right, left), then the four diagonals.
+ */
+template<int Size>
+struct RayTable {
+	static const int DIRECTIONS = 8;
+
+	std::int8_t cells[Size * Size][DIRECTIONS][Size]{};
+	std::int8_t length[Size * Size][DIRECTIONS]{};
+};
+
+/**
+ * @brief Builds the RayTable for a board size.
+ */
+template<int Size>
+constexpr RayTable<Size> makeRayTable()
+{
+	RayTable<Size> table{};
+	const int steps[8][2] = { {1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {1,-1}, {-1,1}, {-1,-1} };
+
+	for (int cell = 0; cell < Size * Size; ++cell)
+	{
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			int row = cell / Size + steps[direction][0];
+			int col = cell % Size + steps[direction][1];
+			int length = 0;
+
+			while (row >= 0 && row < Size && col >= 0 && col < Size)
+			{
+				table.cells[cell][direction][length++] = static_cast<std::int8_t>(row * Size + col);
+				row += steps[direction][0];
+				col += steps[direction][1];
+			}
+			table.length[cell][direction] = static_cast<std::int8_t>(length);
+		}
+	}
+
+	return table;
+}
+
+/// One ray table per board size.
+template<int Size>
+inline constexpr RayTable<Size> RAYS = makeRayTable<Size>();
+
+/**
+ * @class MoveRules
+ * @brief Movement rules for every animal, driven by the ray table and an occupancy mask.
+ *
+ * - Donkey: one step in the four cardinal directions.
+ * - Snake: one step in any of the eight directions.
+ * - Frog: one step in any direction, or jump over a line of touching pieces
+ *   and land on the first empty cell behind them.
+ *
+ * Only empty cells can be moved to.
+ */
+template<int Size>
+class MoveRules
+{
+public:
+	/**
+	 * @brief Bit (row * Size + col) for a cell.
+	 */
+	static std::uint64_t bit(int cell) { return std::uint64_t(1) << cell; }
+
+	/**
+	 * @brief Appends the moves of one piece.
+	 * @param row Piece row.
+	 * @param col Piece column.
+	 * @param type Piece type.
+	 * @param occupied Bit set for every occupied cell.
+	 * @param moves List to append to.
+	 */
+	static void addPieceMoves(int row, int col, AnimalType type, std::uint64_t occupied, MoveList& moves)
+	{
+		// Cardinal directions come first in the table, so donkeys just use the first four
+		const int directions = (type == AnimalType::Donkey) ? 4 : 8;
+		const int cell = row * Size + col;
+
+		for (int direction = 0; direction < directions; ++direction)
+		{
+			if (RAYS<Size>.length[cell][direction] == 0)
+				continue;
+
+			int target = RAYS<Size>.cells[cell][direction][0];
+			if (!(occupied & bit(target)))
+				moves.push_back({ row, col, target / Size, target % Size });
+		}
+
+		if (type != AnimalType::Frog)
+			return;
+
+		for (int direction = 0; direction < 8; ++direction)
+		{
+			const std::int8_t* ray = RAYS<Size>.cells[cell][direction];
+			const int length = RAYS<Size>.length[cell][direction];
+
+			// A jump needs something to jump over, an empty neighbour is already a step move
+			if (length == 0 || !(occupied & bit(ray[0])))
+				continue;
+
+			int i = 1;
+			while (i < length && (occupied & bit(ray[i])))
+				++i;
+
+			if (i < length)
+				moves.push_back({ row, col, ray[i] / Size, ray[i] % Size });
+		}
+	}
+};
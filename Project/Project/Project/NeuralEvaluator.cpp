@@ -0,0 +1,476 @@
+#include "NeuralEvaluator.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+static const char MAGIC[4] = { 'F', 'P', 'N', 'N' };
+static const std::uint32_t VERSION = 1;
+
+/**
+ * @brief Constructs a network with every weight zero.
+ */
+NeuralEvaluator::NeuralEvaluator() : m_outputBias(0), m_ply(0), m_loaded(false)
+{
+	std::memset(m_featureBias, 0, sizeof(m_featureBias));
+	std::memset(m_featureWeights, 0, sizeof(m_featureWeights));
+	std::memset(m_denseBias, 0, sizeof(m_denseBias));
+	std::memset(m_denseWeights, 0, sizeof(m_denseWeights));
+	std::memset(m_outputWeights, 0, sizeof(m_outputWeights));
+	std::memset(m_stack, 0, sizeof(m_stack));
+}
+
+/**
+ * @brief Reads a network file, see the header for the layout.
+ */
+bool NeuralEvaluator::loadWeights(const std::string& path, int boardSize)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	char magic[4];
+	std::uint32_t version = 0, fileBoardSize = 0;
+	file.read(magic, sizeof(magic));
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&fileBoardSize), sizeof(fileBoardSize));
+
+	if (!file || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION) {
+		std::cout << "Error loading network " << path << ": not a network file\n";
+		return false;
+	}
+	if (static_cast<int>(fileBoardSize) != boardSize) {
+		std::cout << "Error loading network " << path << ": trained for " << fileBoardSize << "x" << fileBoardSize
+			<< ", board is " << boardSize << "x" << boardSize << "\n";
+		return false;
+	}
+
+	std::int8_t denseWeights[DENSE][HIDDEN];
+	std::int8_t outputWeights[DENSE];
+
+	file.read(reinterpret_cast<char*>(m_featureBias), sizeof(m_featureBias));
+	file.read(reinterpret_cast<char*>(m_featureWeights), sizeof(m_featureWeights));
+	file.read(reinterpret_cast<char*>(m_denseBias), sizeof(m_denseBias));
+	file.read(reinterpret_cast<char*>(denseWeights), sizeof(denseWeights));
+	file.read(reinterpret_cast<char*>(&m_outputBias), sizeof(m_outputBias));
+	file.read(reinterpret_cast<char*>(outputWeights), sizeof(outputWeights));
+
+	if (!file) {
+		std::cout << "Error loading network " << path << ": file is truncated\n";
+		return false;
+	}
+
+	for (int out = 0; out < DENSE; ++out) {
+		for (int in = 0; in < HIDDEN; ++in) {
+			m_denseWeights[out][in] = denseWeights[out][in];
+		}
+		m_outputWeights[out] = outputWeights[out];
+	}
+
+	m_loaded = true;
+	return true;
+}
+
+/**
+ * @brief Writes the weights back out, narrowing the dense layers to int8.
+ */
+bool NeuralEvaluator::saveWeights(const std::string& path, int boardSize) const
+{
+	std::ofstream file(path, std::ios::binary);
+	if (!file) {
+		return false;
+	}
+
+	std::int8_t denseWeights[DENSE][HIDDEN];
+	std::int8_t outputWeights[DENSE];
+	for (int out = 0; out < DENSE; ++out) {
+		for (int in = 0; in < HIDDEN; ++in) {
+			denseWeights[out][in] = static_cast<std::int8_t>(m_denseWeights[out][in]);
+		}
+		outputWeights[out] = static_cast<std::int8_t>(m_outputWeights[out]);
+	}
+
+	std::uint32_t fileBoardSize = static_cast<std::uint32_t>(boardSize);
+	file.write(MAGIC, sizeof(MAGIC));
+	file.write(reinterpret_cast<const char*>(&VERSION), sizeof(VERSION));
+	file.write(reinterpret_cast<const char*>(&fileBoardSize), sizeof(fileBoardSize));
+	file.write(reinterpret_cast<const char*>(m_featureBias), sizeof(m_featureBias));
+	file.write(reinterpret_cast<const char*>(m_featureWeights), sizeof(m_featureWeights));
+	file.write(reinterpret_cast<const char*>(m_denseBias), sizeof(m_denseBias));
+	file.write(reinterpret_cast<const char*>(denseWeights), sizeof(denseWeights));
+	file.write(reinterpret_cast<const char*>(&m_outputBias), sizeof(m_outputBias));
+	file.write(reinterpret_cast<const char*>(outputWeights), sizeof(outputWeights));
+
+	return static_cast<bool>(file);
+}
+
+/**
+ * @brief Random weights in ranges that keep every layer inside its integer type.
+ */
+void NeuralEvaluator::randomize(unsigned int seed)
+{
+	std::mt19937 rng(seed);
+	auto random = [&rng](int low, int high) { return static_cast<int>(rng() % (high - low + 1)) + low; };
+
+	for (int hidden = 0; hidden < HIDDEN; ++hidden) {
+		m_featureBias[hidden] = static_cast<std::int16_t>(random(-64, 64));
+	}
+	for (int feature = 0; feature < FEATURES; ++feature) {
+		for (int hidden = 0; hidden < HIDDEN; ++hidden) {
+			m_featureWeights[feature][hidden] = static_cast<std::int16_t>(random(-32, 32));
+		}
+	}
+	for (int out = 0; out < DENSE; ++out) {
+		m_denseBias[out] = random(-2000, 2000);
+		for (int in = 0; in < HIDDEN; ++in) {
+			m_denseWeights[out][in] = static_cast<std::int16_t>(random(-64, 64));
+		}
+		m_outputWeights[out] = static_cast<std::int16_t>(random(-127, 127));
+	}
+	m_outputBias = random(-500, 500);
+
+	m_loaded = true;
+}
+
+/**
+ * @brief True once the network has weights.
+ */
+bool NeuralEvaluator::isLoaded() const
+{
+	return m_loaded;
+}
+
+/**
+ * @brief Feature for a piece: cell, then owner, then animal type.
+ */
+int NeuralEvaluator::featureIndex(int cell, const PieceState& piece)
+{
+	if (piece.owner == Player::NoPlayer || piece.type == AnimalType::NoType) {
+		return -1;
+	}
+
+	int owner = (piece.owner == Player::Player1) ? 0 : 1;
+	int type = static_cast<int>(piece.type) - static_cast<int>(AnimalType::Frog);
+	return (cell * 2 + owner) * 3 + type;
+}
+
+/**
+ * @brief Adds one weight column to the accumulator.
+ */
+void NeuralEvaluator::addFeature(std::int16_t* accumulator, int feature) const
+{
+	const std::int16_t* weights = m_featureWeights[feature];
+#if defined(__AVX2__)
+	for (int i = 0; i < HIDDEN; i += 16) {
+		__m256i sum = _mm256_add_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+			_mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i)));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(accumulator + i), sum);
+	}
+#else
+	for (int i = 0; i < HIDDEN; ++i) {
+		accumulator[i] = static_cast<std::int16_t>(accumulator[i] + weights[i]);
+	}
+#endif
+}
+
+/**
+ * @brief Subtracts one weight column from the accumulator.
+ */
+void NeuralEvaluator::subFeature(std::int16_t* accumulator, int feature) const
+{
+	const std::int16_t* weights = m_featureWeights[feature];
+#if defined(__AVX2__)
+	for (int i = 0; i < HIDDEN; i += 16) {
+		__m256i difference = _mm256_sub_epi16(_mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + i)),
+			_mm256_load_si256(reinterpret_cast<const __m256i*>(weights + i)));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(accumulator + i), difference);
+	}
+#else
+	for (int i = 0; i < HIDDEN; ++i) {
+		accumulator[i] = static_cast<std::int16_t>(accumulator[i] - weights[i]);
+	}
+#endif
+}
+
+/**
+ * @brief Bias plus one column per occupied cell.
+ */
+void NeuralEvaluator::refresh(const PieceState* cells, int boardSize)
+{
+	m_ply = 0;
+	std::int16_t* accumulator = m_stack[0];
+	std::memcpy(accumulator, m_featureBias, sizeof(m_featureBias));
+
+	for (int cell = 0; cell < boardSize * boardSize; ++cell)
+	{
+		int feature = featureIndex(cell, cells[cell]);
+		if (feature >= 0) {
+			addFeature(accumulator, feature);
+		}
+	}
+}
+
+/**
+ * @brief Copies the accumulator one slot up the stack.
+ */
+void NeuralEvaluator::push()
+{
+	assert(m_ply < MAX_PLY);
+	std::memcpy(m_stack[m_ply + 1], m_stack[m_ply], sizeof(m_stack[0]));
+	m_ply++;
+}
+
+/**
+ * @brief Drops back to the previous accumulator.
+ */
+void NeuralEvaluator::pop()
+{
+	m_ply--;
+}
+
+/**
+ * @brief A move turns the piece's feature off on one cell and on at another.
+ */
+void NeuralEvaluator::movePiece(int fromCell, int toCell, const PieceState& piece)
+{
+	subFeature(m_stack[m_ply], featureIndex(fromCell, piece));
+	addFeature(m_stack[m_ply], featureIndex(toCell, piece));
+}
+
+/**
+ * @brief Network output for perspective, SIMD when available.
+ */
+int NeuralEvaluator::evaluate(Player perspective) const
+{
+#if defined(__AVX2__)
+	int score = forwardSimd(m_stack[m_ply]);
+#else
+	int score = forwardScalar(m_stack[m_ply]);
+#endif
+	return (perspective == Player::Player1) ? score : -score;
+}
+
+/**
+ * @brief Network output for perspective using the scalar kernels.
+ */
+int NeuralEvaluator::evaluateScalar(Player perspective) const
+{
+	int score = forwardScalar(m_stack[m_ply]);
+	return (perspective == Player::Player1) ? score : -score;
+}
+
+/**
+ * @brief Clipped ReLU, dense layer, clipped ReLU, output. Reference for the SIMD version.
+ */
+int NeuralEvaluator::forwardScalar(const std::int16_t* accumulator) const
+{
+	std::int16_t hidden[HIDDEN];
+	for (int i = 0; i < HIDDEN; ++i) {
+		hidden[i] = static_cast<std::int16_t>(std::min<int>(std::max<int>(accumulator[i], 0), CLIP));
+	}
+
+	std::int16_t dense[DENSE];
+	for (int out = 0; out < DENSE; ++out)
+	{
+		std::int32_t sum = 0;
+		for (int in = 0; in < HIDDEN; ++in) {
+			sum += hidden[in] * m_denseWeights[out][in];
+		}
+		dense[out] = static_cast<std::int16_t>(std::min(std::max((sum + m_denseBias[out]) >> DENSE_SHIFT, 0), CLIP));
+	}
+
+	std::int32_t output = 0;
+	for (int in = 0; in < DENSE; ++in) {
+		output += dense[in] * m_outputWeights[in];
+	}
+
+	return (output + m_outputBias) >> OUTPUT_SHIFT;
+}
+
+#if defined(__AVX2__)
+/**
+ * @brief Adds the eight int32 lanes of a register.
+ */
+static std::int32_t horizontalSum(__m256i sum)
+{
+	__m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+	half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(half);
+}
+#endif
+
+/**
+ * @brief AVX2 forward pass. Activations and weights are int16, so madd_epi16 does
+ *        16 multiplies and 8 pairwise adds per instruction with no rounding anywhere.
+ */
+int NeuralEvaluator::forwardSimd(const std::int16_t* accumulator) const
+{
+#if defined(__AVX2__)
+	static const int CHUNKS = HIDDEN / 16;
+
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i clip = _mm256_set1_epi16(CLIP);
+
+	__m256i hidden[CHUNKS];
+	for (int chunk = 0; chunk < CHUNKS; ++chunk) {
+		__m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(accumulator + chunk * 16));
+		hidden[chunk] = _mm256_min_epi16(_mm256_max_epi16(value, zero), clip);
+	}
+
+	// Eight outputs at a time: hadd folds eight dot product registers into one register of sums
+	__m256i activations[DENSE / 8];
+	for (int group = 0; group < DENSE / 8; ++group)
+	{
+		__m256i sums[8];
+		for (int i = 0; i < 8; ++i)
+		{
+			const std::int16_t* weights = m_denseWeights[group * 8 + i];
+			sums[i] = zero;
+			for (int chunk = 0; chunk < CHUNKS; ++chunk) {
+				sums[i] = _mm256_add_epi32(sums[i], _mm256_madd_epi16(hidden[chunk],
+					_mm256_load_si256(reinterpret_cast<const __m256i*>(weights + chunk * 16))));
+			}
+		}
+
+		__m256i low = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[0], sums[1]), _mm256_hadd_epi32(sums[2], sums[3]));
+		__m256i high = _mm256_hadd_epi32(_mm256_hadd_epi32(sums[4], sums[5]), _mm256_hadd_epi32(sums[6], sums[7]));
+		__m256i total = _mm256_add_epi32(_mm256_permute2x128_si256(low, high, 0x20), _mm256_permute2x128_si256(low, high, 0x31));
+
+		total = _mm256_add_epi32(total, _mm256_load_si256(reinterpret_cast<const __m256i*>(m_denseBias + group * 8)));
+		total = _mm256_srai_epi32(total, DENSE_SHIFT);
+		activations[group] = _mm256_min_epi32(_mm256_max_epi32(total, zero), _mm256_set1_epi32(CLIP));
+	}
+
+	// Back to int16 in order (packs works per 128 bit half, the permute undoes that)
+	__m256i dense = _mm256_permute4x64_epi64(_mm256_packs_epi32(activations[0], activations[1]), _MM_SHUFFLE(3, 1, 2, 0));
+	__m256i products = _mm256_madd_epi16(dense, _mm256_load_si256(reinterpret_cast<const __m256i*>(m_outputWeights)));
+
+	return (horizontalSum(products) + m_outputBias) >> OUTPUT_SHIFT;
+#else
+	return forwardScalar(accumulator);
+#endif
+}
+
+/**
+ * @brief Plays random games with the network attached to the search rules and
+ *        checks every incremental accumulator against a fresh refresh.
+ */
+void NeuralEvaluator::runBenchmark(int positions)
+{
+	static_assert(DENSE == 16, "Output layer kernel is one register");
+
+	NeuralEvaluator* incremental = new NeuralEvaluator();
+	NeuralEvaluator* fresh = new NeuralEvaluator();
+	incremental->randomize(1234);
+	fresh->randomize(1234);
+
+	Gameplay rules;
+	rules.setNeuralEvaluator(incremental);
+	std::mt19937 rng(42);
+
+	std::vector<Boardstate> states;
+	int refreshMismatches = 0, scalarMismatches = 0;
+
+	while (static_cast<int>(states.size()) < positions)
+	{
+		Boardstate state = Gameplay::randomStartingPosition(rng);
+		incremental->refresh(&state.grid[0][0], BOARD_SIZE);
+
+		std::vector<Move> played;
+		int plies = 1 + static_cast<int>(rng() % 20);
+		for (int ply = 0; ply < plies && ply < MAX_PLY; ++ply)
+		{
+			std::vector<Move> moves = rules.generateMoves(state);
+			if (moves.empty()) break;
+			Move move = moves[rng() % moves.size()];
+			rules.doMove(state, move);
+			played.push_back(move);
+
+			fresh->refresh(&state.grid[0][0], BOARD_SIZE);
+			if (incremental->evaluate(Player::Player1) != fresh->evaluate(Player::Player1)) refreshMismatches++;
+			if (incremental->evaluate(Player::Player1) != incremental->evaluateScalar(Player::Player1)) scalarMismatches++;
+
+			states.push_back(state);
+		}
+
+		// Unwinding must land back on the starting accumulator
+		while (!played.empty()) {
+			rules.undoMove(state, played.back());
+			played.pop_back();
+		}
+		fresh->refresh(&state.grid[0][0], BOARD_SIZE);
+		if (incremental->evaluate(Player::Player1) != fresh->evaluate(Player::Player1)) refreshMismatches++;
+	}
+
+	// One move per position for the incremental timing: its first piece to its first empty cell
+	std::vector<int> fromCells, toCells;
+	for (const Boardstate& state : states)
+	{
+		const PieceState* cells = &state.grid[0][0];
+		int from = 0, to = 0;
+		while (cells[from].owner == Player::NoPlayer) from++;
+		while (cells[to].owner != Player::NoPlayer) to++;
+		fromCells.push_back(from);
+		toCells.push_back(to);
+	}
+
+	const int repeats = 10;
+	long long checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		for (const Boardstate& state : states)
+			checksum += rules.evaluateBoard(state, Player::Player1);
+	auto afterHeuristic = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		for (const Boardstate& state : states) {
+			fresh->refresh(&state.grid[0][0], BOARD_SIZE);
+			checksum += fresh->evaluate(Player::Player1);
+		}
+	auto afterRefresh = std::chrono::steady_clock::now();
+	for (int r = 0; r < repeats; ++r)
+		for (const Boardstate& state : states) {
+			fresh->refresh(&state.grid[0][0], BOARD_SIZE);
+			checksum += fresh->evaluateScalar(Player::Player1);
+		}
+	auto afterScalar = std::chrono::steady_clock::now();
+	fresh->refresh(&states[0].grid[0][0], BOARD_SIZE);
+	for (int r = 0; r < repeats; ++r)
+		for (std::size_t i = 0; i < states.size(); ++i) {
+			fresh->push();
+			fresh->movePiece(fromCells[i], toCells[i], states[i].grid[fromCells[i] / BOARD_SIZE][fromCells[i] % BOARD_SIZE]);
+			checksum += fresh->evaluate(Player::Player1);
+			fresh->pop();
+		}
+	auto end = std::chrono::steady_clock::now();
+
+	double total = static_cast<double>(states.size()) * repeats;
+	auto perPosition = [total](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+		return std::chrono::duration<double, std::nano>(to - from).count() / total;
+	};
+
+	std::cout << "evaluateBoard:                     " << perPosition(start, afterHeuristic) << " ns/position\n";
+	std::cout << "network refresh + output" <<
+#if defined(__AVX2__)
+		" (AVX2):   "
+#else
+		" (scalar): "
+#endif
+		<< perPosition(afterHeuristic, afterRefresh) << " ns/position\n";
+	std::cout << "network refresh + output (scalar): " << perPosition(afterRefresh, afterScalar) << " ns/position\n";
+	std::cout << "network move update + output:      " << perPosition(afterScalar, end) << " ns/position\n";
+	std::cout << refreshMismatches << " incremental/refresh mismatches, " << scalarMismatches
+		<< " SIMD/scalar mismatches in " << states.size() << " positions (checksum " << checksum << ")\n";
+
+	delete incremental;
+	delete fresh;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+#include <string>
+/**
+ * @file NeuralEvaluator.h
+ * @brief Small efficiently updatable neural network (NNUE style) board evaluation.
+ */
+
+/**
+ * @class NeuralEvaluator
+ * @brief Quantised network: sparse first layer kept as an incremental accumulator,
+ *        then two small int8 dense layers.
+ *
+ * Input features are one per (cell, owner, animal type). A move only turns one
+ * feature off and one on, so instead of recomputing the first layer the search
+ * keeps a stack of accumulators and adds/subtracts two weight columns per move.
+ *
+ *   features (MAX_CELLS * 2 * 3) -> HIDDEN int16 accumulator -> clipped ReLU
+ *   -> DENSE int8 layer -> clipped ReLU -> 1 output
+ *
+ * Every layer is integer maths, so the AVX2 kernels and the scalar fallback give
+ * exactly the same result. The output is from Player 1's point of view.
+ */
+class NeuralEvaluator
+{
+public:
+	static constexpr int MAX_CELLS = 64;                ///< Largest board supported (8x8)
+	static constexpr int FEATURES = MAX_CELLS * 2 * 3;  ///< Cell * owner * animal type
+	static constexpr int HIDDEN = 64;                   ///< Accumulator width
+	static constexpr int DENSE = 16;                    ///< Second layer width
+	/// Deepest push() nesting: the root move and MAX_SEARCH_DEPTH plies below it, plus a
+	/// threat and its reply for each threat the pre-check may chain.
+	static constexpr int MAX_PLY = MAX_SEARCH_DEPTH + 1 + 2 * MAX_THREAT_DEPTH;
+	static constexpr int CLIP = 127;                    ///< Clipped ReLU ceiling
+	static constexpr int DENSE_SHIFT = 6;               ///< Scales the dense layer back to the activation range
+	static constexpr int OUTPUT_SHIFT = 4;              ///< Scales the output to evaluateBoard units
+
+	/**
+	 * @brief Constructs an empty network (all weights zero).
+	 */
+	NeuralEvaluator();
+
+	/**
+	 * @brief Loads weights from a binary file.
+	 *
+	 * Layout (little endian): "FPNN", uint32 version, uint32 board size,
+	 * int16 feature bias[HIDDEN], int16 feature weights[FEATURES][HIDDEN],
+	 * int32 dense bias[DENSE], int8 dense weights[DENSE][HIDDEN],
+	 * int32 output bias, int8 output weights[DENSE].
+	 * @param path File to read.
+	 * @param boardSize Board size the network must have been trained for.
+	 * @return true if the file was read and matches boardSize.
+	 */
+	bool loadWeights(const std::string& path, int boardSize);
+
+	/**
+	 * @brief Writes the current weights in the format loadWeights reads.
+	 */
+	bool saveWeights(const std::string& path, int boardSize) const;
+
+	/**
+	 * @brief Fills every weight with small random values. Used by the benchmark.
+	 */
+	void randomize(unsigned int seed);
+
+	/**
+	 * @brief True once weights have been loaded (or randomised).
+	 */
+	bool isLoaded() const;
+
+	/**
+	 * @brief Rebuilds the accumulator from scratch and empties the stack.
+	 * @param cells Board cells in row major order.
+	 * @param boardSize Cells per side.
+	 */
+	void refresh(const PieceState* cells, int boardSize);
+
+	/**
+	 * @brief Saves the accumulator before a move so pop() can restore it.
+	 */
+	void push();
+
+	/**
+	 * @brief Restores the accumulator saved by the matching push().
+	 */
+	void pop();
+
+	/**
+	 * @brief Incrementally moves a piece from one cell to another.
+	 */
+	void movePiece(int fromCell, int toCell, const PieceState& piece);
+
+	/**
+	 * @brief Runs the dense layers on the current accumulator.
+	 * @param perspective Player the score is for.
+	 * @return Score in the same units as Gameplay::evaluateBoard.
+	 */
+	int evaluate(Player perspective) const;
+
+	/**
+	 * @brief Same as evaluate() but never uses SIMD.
+	 */
+	int evaluateScalar(Player perspective) const;
+
+	/**
+	 * @brief Checks incremental updates against refresh and SIMD against scalar
+	 *        on random games, and prints the time per evaluation.
+	 */
+	static void runBenchmark(int positions);
+
+private:
+	/**
+	 * @brief Index of the input feature for a piece on a cell, or -1 for an empty cell.
+	 */
+	static int featureIndex(int cell, const PieceState& piece);
+
+	void addFeature(std::int16_t* accumulator, int feature) const;
+	void subFeature(std::int16_t* accumulator, int feature) const;
+
+	int forwardScalar(const std::int16_t* accumulator) const;
+	int forwardSimd(const std::int16_t* accumulator) const;
+
+	alignas(32) std::int16_t m_featureBias[HIDDEN];
+	alignas(32) std::int16_t m_featureWeights[FEATURES][HIDDEN];
+	alignas(32) std::int32_t m_denseBias[DENSE];
+	alignas(32) std::int16_t m_denseWeights[DENSE][HIDDEN]; ///< int8 in the file, widened for madd
+	std::int32_t m_outputBias;
+	alignas(32) std::int16_t m_outputWeights[DENSE];        ///< int8 in the file, widened for madd
+
+	alignas(32) std::int16_t m_stack[MAX_PLY + 1][HIDDEN];  ///< Accumulator per search ply
+	int m_ply;
+	bool m_loaded;
+};
@@ -0,0 +1,301 @@
+#include "PositionString.h"
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static_assert(BOARD_SIZE <= 9, "Runs of empty cells are one digit");
+
+/// Letters of the animal types for Player 1, Player 2 uses lower case.
+static constexpr char PIECE_LETTERS[4] = { '.', 'F', 'S', 'D' };
+
+/// Pieces in a whole set, per animal type.
+static const std::uint8_t FULL_SET[4] = { 0, 1, 1, 3 };
+
+/**
+ * @brief Owner * 4 + type for every ASCII letter of a piece, 0 for anything else.
+ */
+struct LetterTable {
+	std::uint8_t piece[128]{};
+};
+
+static constexpr LetterTable makeLetterTable()
+{
+	LetterTable table{};
+	for (int type = AnimalType::Frog; type <= AnimalType::Donkey; ++type)
+	{
+		table.piece[static_cast<int>(PIECE_LETTERS[type])] = static_cast<std::uint8_t>(Player::Player1 * 4 + type);
+		table.piece[PIECE_LETTERS[type] - 'A' + 'a'] = static_cast<std::uint8_t>(Player::Player2 * 4 + type);
+	}
+	return table;
+}
+
+static constexpr LetterTable LETTERS = makeLetterTable();
+
+/**
+ * @brief Piece for a letter.
+ * @return false if the letter is not a piece.
+ */
+static bool pieceFromLetter(char letter, PieceState& piece)
+{
+	const unsigned char index = static_cast<unsigned char>(letter);
+	if (index >= 128 || LETTERS.piece[index] == 0)
+		return false;
+
+	piece = { static_cast<Player>(LETTERS.piece[index] >> 2), static_cast<AnimalType>(LETTERS.piece[index] & 3) };
+	return true;
+}
+
+static char letterOf(Player owner, int type)
+{
+	return (owner == Player::Player2) ? static_cast<char>(PIECE_LETTERS[type] - 'A' + 'a') : PIECE_LETTERS[type];
+}
+
+Hand Hand::full()
+{
+	Hand hand;
+	for (int player = Player::Player1; player <= Player::Player2; ++player)
+		for (int type = AnimalType::Frog; type <= AnimalType::Donkey; ++type)
+			hand.count[player][type] = FULL_SET[type];
+	return hand;
+}
+
+Hand Hand::offBoard(const Boardstate& state)
+{
+	Hand hand = full();
+	for (int row = 0; row < BOARD_SIZE; ++row)
+	{
+		for (int col = 0; col < BOARD_SIZE; ++col)
+		{
+			const PieceState& piece = state.grid[row][col];
+			std::uint8_t& count = hand.count[piece.owner][piece.type];
+			if (piece.owner != Player::NoPlayer && count > 0) {
+				count--;
+			}
+		}
+	}
+	return hand;
+}
+
+bool Hand::operator==(const Hand& other) const
+{
+	for (int player = 0; player < 3; ++player)
+		for (int type = 0; type < 4; ++type)
+			if (count[player][type] != other.count[player][type])
+				return false;
+	return true;
+}
+
+/**
+ * @brief One pass over the text, writing into locals until the whole string checks out.
+ */
+bool PositionString::parse(std::string_view text, Boardstate& state, Hand& hand)
+{
+	Boardstate board;
+	board.clear(Player::NoPlayer);
+
+	std::size_t i = 0;
+	int row = 0, col = 0;
+	for (; i < text.size() && text[i] != ' '; ++i)
+	{
+		const char c = text[i];
+		if (c == '/')
+		{
+			if (col != BOARD_SIZE || ++row == BOARD_SIZE)
+				return false;
+			col = 0;
+		}
+		else if (c >= '1' && c <= '9')
+		{
+			col += c - '0';
+			if (col > BOARD_SIZE)
+				return false;
+		}
+		else
+		{
+			PieceState piece;
+			if (col == BOARD_SIZE || !pieceFromLetter(c, piece))
+				return false;
+			board.grid[row][col++] = piece;
+		}
+	}
+	if (row != BOARD_SIZE - 1 || col != BOARD_SIZE)
+		return false;
+
+	// " 1 " or " 2 "
+	if (i + 3 >= text.size() || text[i] != ' ' || (text[i + 1] != '1' && text[i + 1] != '2') || text[i + 2] != ' ')
+		return false;
+	board.currentPlayer = (text[i + 1] == '1') ? Player::Player1 : Player::Player2;
+	i += 3;
+
+	Hand pieces;
+	if (text.substr(i) != "-")
+	{
+		for (; i < text.size(); ++i)
+		{
+			PieceState piece;
+			// More than a whole set of a piece is no position, and would not format back
+			if (!pieceFromLetter(text[i], piece) || pieces.count[piece.owner][piece.type] == FULL_SET[piece.type])
+				return false;
+			pieces.count[piece.owner][piece.type]++;
+		}
+	}
+
+	state = board;
+	hand = pieces;
+	return true;
+}
+
+int PositionString::format(const Boardstate& state, const Hand& hand, char* buffer)
+{
+	int length = 0;
+
+	for (int row = 0; row < BOARD_SIZE; ++row)
+	{
+		if (row > 0) buffer[length++] = '/';
+
+		int empty = 0;
+		for (int col = 0; col < BOARD_SIZE; ++col)
+		{
+			const PieceState& piece = state.grid[row][col];
+			if (piece.owner == Player::NoPlayer) {
+				empty++;
+				continue;
+			}
+			if (empty > 0) {
+				buffer[length++] = static_cast<char>('0' + empty);
+				empty = 0;
+			}
+			buffer[length++] = letterOf(piece.owner, piece.type);
+		}
+		if (empty > 0) buffer[length++] = static_cast<char>('0' + empty);
+	}
+
+	buffer[length++] = ' ';
+	buffer[length++] = (state.currentPlayer == Player::Player2) ? '2' : '1';
+	buffer[length++] = ' ';
+
+	const int handStart = length;
+	for (int player = Player::Player1; player <= Player::Player2; ++player)
+	{
+		for (int type = AnimalType::Frog; type <= AnimalType::Donkey; ++type)
+		{
+			// A hand bigger than a whole set does not fit the buffer
+			int count = hand.count[player][type];
+			assert(count <= FULL_SET[type]);
+			for (int i = 0; i < count; ++i) {
+				buffer[length++] = letterOf(static_cast<Player>(player), type);
+			}
+		}
+	}
+	if (length == handStart) buffer[length++] = '-';
+
+	return length;
+}
+
+std::string PositionString::toString(const Boardstate& state, const Hand& hand)
+{
+	char buffer[MAX_LENGTH];
+	return std::string(buffer, format(state, hand, buffer));
+}
+
+std::string PositionString::moveText(const Move& move)
+{
+	if (!move.isValid())
+		return "-";
+
+	const char text[4] = {
+		static_cast<char>('a' + move.col1), static_cast<char>('1' + move.row1),
+		static_cast<char>('a' + move.col2), static_cast<char>('1' + move.row2)
+	};
+	return std::string(text, 4);
+}
+
+Move PositionString::parseMove(std::string_view text)
+{
+	if (text.size() != 4)
+		return Move();
+
+	int col1 = text[0] - 'a', row1 = text[1] - '1';
+	int col2 = text[2] - 'a', row2 = text[3] - '1';
+	for (int coordinate : { col1, row1, col2, row2 }) {
+		if (coordinate < 0 || coordinate >= BOARD_SIZE)
+			return Move();
+	}
+
+	return Move(row1, col1, row2, col2);
+}
+
+/**
+ * @brief Random placements plus up to 20 random moves, some with pieces still in hand.
+ */
+void PositionString::runBenchmark(int positions)
+{
+	std::mt19937 rng(7);
+	Gameplay rules;
+
+	std::vector<Boardstate> states;
+	std::vector<Hand> hands;
+	states.reserve(positions);
+	hands.reserve(positions);
+	MoveList moves;
+	while (static_cast<int>(states.size()) < positions)
+	{
+		Boardstate state = Gameplay::randomStartingPosition(rng);
+		int plies = static_cast<int>(rng() % 20);
+		for (int ply = 0; ply < plies; ++ply) {
+			rules.generateMoves(state, moves);
+			if (moves.empty()) break;
+			state = rules.makeMove(state, moves[rng() % moves.size()]);
+		}
+
+		// Every fourth position loses a piece back to its owner's hand
+		if (states.size() % 4 == 0) {
+			int cell = static_cast<int>(rng() % (BOARD_SIZE * BOARD_SIZE));
+			state.grid[cell / BOARD_SIZE][cell % BOARD_SIZE] = { Player::NoPlayer, AnimalType::NoType };
+		}
+
+		states.push_back(state);
+		hands.push_back(Hand::offBoard(state));
+	}
+
+	std::vector<char> text(static_cast<std::size_t>(positions) * MAX_LENGTH);
+	std::vector<int> lengths(positions);
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < positions; ++i) {
+		lengths[i] = format(states[i], hands[i], &text[static_cast<std::size_t>(i) * MAX_LENGTH]);
+	}
+	auto middle = std::chrono::steady_clock::now();
+
+	int failures = 0;
+	Boardstate parsed;
+	Hand parsedHand;
+	for (int i = 0; i < positions; ++i) {
+		failures += !parse(std::string_view(&text[static_cast<std::size_t>(i) * MAX_LENGTH], lengths[i]), parsed, parsedHand);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	// Round trip check, outside the timed loops
+	int mismatches = 0;
+	for (int i = 0; i < positions; ++i)
+	{
+		parse(std::string_view(&text[static_cast<std::size_t>(i) * MAX_LENGTH], lengths[i]), parsed, parsedHand);
+		bool same = parsed.currentPlayer == states[i].currentPlayer && parsedHand == hands[i];
+		for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE && same; ++cell) {
+			const PieceState& a = parsed.grid[cell / BOARD_SIZE][cell % BOARD_SIZE];
+			const PieceState& b = states[i].grid[cell / BOARD_SIZE][cell % BOARD_SIZE];
+			same = a.owner == b.owner && a.type == b.type;
+		}
+		mismatches += !same;
+	}
+
+	double formatNs = std::chrono::duration<double, std::nano>(middle - start).count() / positions;
+	double parseNs = std::chrono::duration<double, std::nano>(end - middle).count() / positions;
+	std::cout << positions << " positions, e.g. \"" << std::string_view(text.data(), lengths[0]) << "\"\n"
+		<< "format " << formatNs << " ns, parse " << parseNs << " ns per position ("
+		<< std::chrono::duration<double, std::milli>(end - middle).count() << " ms to parse all), "
+		<< failures << " parse failures, " << mismatches << " round trip mismatches\n";
+}
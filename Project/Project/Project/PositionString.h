@@ -0,0 +1,89 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+/**
+ * @file PositionString.h
+ * @brief One-line text form of a position, the key for headless tools, tests and position sets.
+ */
+
+/**
+ * @struct Hand
+ * @brief Pieces each player still has to place.
+ */
+struct Hand {
+	std::uint8_t count[3][4]{}; ///< [Player][AnimalType]
+
+	/**
+	 * @brief A whole set for both players: one frog, one snake and three donkeys each.
+	 */
+	static Hand full();
+
+	/**
+	 * @brief Whatever of the whole set is not on the board.
+	 */
+	static Hand offBoard(const Boardstate& state);
+
+	bool operator==(const Hand& other) const;
+};
+
+/**
+ * @class PositionString
+ * @brief FEN-like text for a Boardstate and both hands.
+ *
+ * Three fields separated by single spaces:
+ *   board  rows from row 0 down, separated by '/'; F S D are Player 1's frog, snake
+ *          and donkey, f s d Player 2's, a digit is that many empty cells
+ *   side   1 or 2, the player to move
+ *   hand   the unplaced pieces in the same letters, '-' when both hands are empty
+ * For example "2D2/1s3/5/3F1/d4 1 SDDfdd".
+ *
+ * Parsing and formatting never allocate. Moves are written as column letter and
+ * row number of both cells, "b2c3" moves the piece on row 1, column 1 to row 2, column 2.
+ */
+class PositionString
+{
+public:
+	/// Longest string format writes.
+	static const int MAX_LENGTH = BOARD_SIZE * BOARD_SIZE + BOARD_SIZE - 1 + 3 + 2 * 5;
+
+	/**
+	 * @brief Reads a position string.
+	 * @param text Exactly one position string, no leading or trailing spaces.
+	 * @param state Set to the board and side to move, only on success.
+	 * @param hand Set to the unplaced pieces, only on success.
+	 * @return false if the text is not a position string.
+	 */
+	static bool parse(std::string_view text, Boardstate& state, Hand& hand);
+
+	/**
+	 * @brief Writes a position string, not zero terminated.
+	 * @param hand At most a whole set of each piece, as parse and Hand::offBoard give.
+	 * @param buffer At least MAX_LENGTH characters.
+	 * @return Characters written.
+	 */
+	static int format(const Boardstate& state, const Hand& hand, char* buffer);
+
+	/**
+	 * @brief format into a new string.
+	 */
+	static std::string toString(const Boardstate& state, const Hand& hand);
+
+	/**
+	 * @brief Move as text, "-" for an invalid Move.
+	 */
+	static std::string moveText(const Move& move);
+
+	/**
+	 * @brief Reads a move like b2c3, an invalid Move if the text is not one.
+	 *        Only checks that both cells are on the board.
+	 */
+	static Move parseMove(std::string_view text);
+
+	/**
+	 * @brief Formats and parses random positions, checks every round trip and
+	 *        prints the time per position.
+	 */
+	static void runBenchmark(int positions);
+};
@@ -0,0 +1,114 @@
+#include "SearchBench.h"
+#include "PositionString.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/// Random placements followed by a few random moves, with the quiet ones kept.
+static const char* const POSITIONS[SearchBench::POSITION_COUNT] = {
+	"1d1fs/3S1/D3d/D4/1dF1D 1 -",
+	"1dd2/D4/1dD1D/4f/1SF1s 2 -",
+	"1DFf1/1d2D/2SDd/2d2/s4 2 -",
+	"DD3/3S1/1fFDs/3d1/1dd2 2 -",
+	"d1D2/df1D1/4s/1D1F1/1d2S 1 -",
+	"5/d1Dd1/fd1F1/1S2D/1D1s1 2 -",
+	"Ss3/1D1F1/D3d/1f1d1/d1D2 2 -",
+	"3d1/d1s1D/1f2D/4d/FS1D1 1 -",
+};
+
+const char* SearchBench::position(int index)
+{
+	return POSITIONS[index];
+}
+
+/**
+ * @brief Each position starts from an empty table, so the result does not depend on the order.
+ */
+void SearchBench::runTimeToDepth(int maxDepth, std::size_t hashMegabytes)
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+	TranspositionTable table(hashMegabytes);
+	rules.setTranspositionTable(&table);
+
+	std::uint64_t totalNodes = 0;
+	double totalMs = 0.0;
+	std::cout << std::fixed << std::setprecision(1);
+
+	for (int index = 0; index < POSITION_COUNT; ++index)
+	{
+		Boardstate state;
+		Hand hand;
+		if (!PositionString::parse(POSITIONS[index], state, hand)) {
+			std::cout << "Position " << index << " does not parse: " << POSITIONS[index] << "\n";
+			continue;
+		}
+
+		table.clear();
+		std::cout << POSITIONS[index] << "\n";
+
+		auto start = std::chrono::steady_clock::now();
+		std::uint64_t nodes = 0;
+		for (int depth = 1; depth <= maxDepth; ++depth)
+		{
+			Move best = rules.chooseBestMove(state, depth - 1);
+			nodes += rules.getNodesEvaluated();
+			double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			std::cout << "  depth " << depth << "  " << ms << " ms  " << nodes << " nodes  score "
+				<< rules.getLastScore() << "  best " << PositionString::moveText(best) << "\n";
+		}
+
+		totalNodes += nodes;
+		totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::cout << POSITION_COUNT << " positions to depth " << maxDepth << ": " << totalNodes << " nodes in "
+		<< totalMs << " ms, " << static_cast<std::uint64_t>(totalNodes / (std::max(totalMs, 0.001) / 1000.0))
+		<< " nodes/sec\n";
+}
+
+/**
+ * @brief The settings that change what is searched are all set here, not left at defaults.
+ */
+std::uint64_t SearchBench::signature(int depth)
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+	rules.setThreatDepth(2);
+	TranspositionTable table(BENCH_HASH_MEGABYTES);
+	rules.setTranspositionTable(&table);
+
+	std::uint64_t nodes = 0;
+	for (int index = 0; index < POSITION_COUNT; ++index)
+	{
+		Boardstate state;
+		Hand hand;
+		PositionString::parse(POSITIONS[index], state, hand);
+
+		table.clear();
+		rules.setSeed(1);
+		for (int iteration = 1; iteration <= depth; ++iteration)
+		{
+			rules.chooseBestMove(state, iteration - 1);
+			nodes += rules.getNodesEvaluated();
+		}
+	}
+
+	return nodes;
+}
+
+void SearchBench::runBench(int depth)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::uint64_t nodes = signature(depth);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << std::fixed << std::setprecision(1)
+		<< POSITION_COUNT << " positions, depth " << depth << "\n"
+		<< "Nodes searched: " << nodes << "\n"
+		<< "Time: " << ms << " ms\n"
+		<< "Nodes/second: " << static_cast<std::uint64_t>(nodes / (std::max(ms, 0.001) / 1000.0)) << "\n";
+}
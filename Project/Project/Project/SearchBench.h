@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+/**
+ * @file SearchBench.h
+ * @brief Fixed movement phase positions the alpha-beta search is timed on.
+ */
+
+/**
+ * @class SearchBench
+ * @brief Runs the search over a suite of positions written as PositionStrings.
+ *
+ * The suite is fixed so runs on different machines and builds can be compared.
+ * None of its positions has a win in one for either side or a forced win by
+ * threats for the side to move, so every one of them is a full search.
+ */
+class SearchBench
+{
+public:
+	/// Positions in the suite.
+	static const int POSITION_COUNT = 8;
+
+	/// Depth the bench command searches to, in plies.
+	static const int BENCH_DEPTH = 6;
+
+	/// Table size of the bench, the signature depends on it.
+	static const std::size_t BENCH_HASH_MEGABYTES = 16;
+
+	/**
+	 * @brief Suite position by index, as a PositionString.
+	 */
+	static const char* position(int index);
+
+	/**
+	 * @brief Deepens every position one ply at a time up to maxDepth with a fresh table,
+	 *        printing the time taken to reach each depth, then the nodes per second overall.
+	 * @param maxDepth Plies, as in EngineProtocol: depth d is chooseBestMove(d - 1).
+	 * @param hashMegabytes Transposition table size.
+	 */
+	static void runTimeToDepth(int maxDepth, std::size_t hashMegabytes);
+
+	/**
+	 * @brief Deepens every position to depth on one thread, each from a cleared table and
+	 *        the same seed. The total is the same on every run and machine until a change
+	 *        alters what the search visits, so it is a signature of the search.
+	 * @param depth Plies, as in runTimeToDepth.
+	 * @return Total nodes.
+	 */
+	static std::uint64_t signature(int depth);
+
+	/**
+	 * @brief Prints the signature and the nodes per second it took.
+	 */
+	static void runBench(int depth);
+};
@@ -0,0 +1,125 @@
+#include "SelfPlay.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Starts the workers, waits for them and reports throughput.
+ */
+std::size_t SelfPlay::run(const SelfPlaySettings& settings)
+{
+	std::atomic<int> nextGame{ 0 };
+	std::atomic<std::size_t> records{ 0 };
+	std::atomic<int> decisiveGames{ 0 };
+
+	int threads = std::max(1, settings.threads);
+	std::cout << "Self-play: " << settings.games << " games at depth " << settings.depth
+		<< " on " << threads << " threads -> " << settings.outputPrefix << "-t*.bin\n";
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<std::thread> workers;
+	for (int thread = 0; thread < threads; ++thread) {
+		workers.emplace_back(&SelfPlay::worker, std::cref(settings), thread,
+			std::ref(nextGame), std::ref(records), std::ref(decisiveGames));
+	}
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Wrote " << records << " positions from " << settings.games << " games ("
+		<< decisiveGames << " decisive) in " << seconds << "s, "
+		<< static_cast<long long>(records / std::max(seconds, 1e-9)) << " positions/sec\n";
+
+	return records;
+}
+
+/**
+ * @brief Plays whole games, buffering one game's records until its result is known.
+ */
+void SelfPlay::worker(const SelfPlaySettings& settings, int thread, std::atomic<int>& nextGame,
+	std::atomic<std::size_t>& records, std::atomic<int>& decisiveGames)
+{
+	ShardWriter writer(settings.outputPrefix + "-t" + std::to_string(thread), settings.recordsPerShard, settings.bufferRecords);
+
+	Gameplay rules;
+	rules.setVerbose(false);
+
+	std::vector<TrainingRecord> gameRecords;
+	gameRecords.reserve(settings.maxPlies);
+
+	// Only repetitions here, maxPlies already bounds the length
+	DrawRules drawRules;
+	drawRules.repetitions = settings.repetitions;
+	drawRules.maxMovementPlies = 0;
+	std::vector<std::uint64_t> keys;
+
+	for (int game = nextGame++; game < settings.games && !writer.hasFailed(); game = nextGame++)
+	{
+		std::mt19937 rng(settings.seed + static_cast<unsigned int>(game));
+		rules.setSeed(settings.seed + static_cast<unsigned int>(game));
+		Boardstate state = Gameplay::randomStartingPosition(rng);
+		Player winner = Player::NoPlayer;
+		gameRecords.clear();
+
+		GameRecord gameRecord;
+		gameRecord.begin(settings.seed + static_cast<unsigned int>(game), true, true, settings.depth);
+		gameRecord.addDrops(state);
+
+		// A few random moves so games from the same placement spread out
+		MoveList moves;
+		for (int ply = 0; ply < settings.randomPlies && winner == Player::NoPlayer; ++ply)
+		{
+			rules.generateMoves(state, moves);
+			if (moves.empty()) break;
+			const Move& move = moves[rng() % moves.size()];
+			gameRecord.addMove(move);
+			rules.doMove(state, move);
+			rules.checkWimCondition(state, winner);
+		}
+		// Positions decided by the random moves say nothing about the search
+		if (winner != Player::NoPlayer)
+			continue;
+
+		keys.assign(1, Gameplay::positionKey(state));
+		for (int ply = 0; ply < settings.maxPlies && !drawRules.isDraw(keys, ply); ++ply)
+		{
+			rules.setGameHistory(keys);
+			Move move = rules.chooseBestMove(state, settings.depth);
+			if (!move.isValid())
+				break;
+
+			gameRecords.push_back(TrainingRecord::fromBoardstate(state, rules.getLastScore(), ply, static_cast<std::uint32_t>(game)));
+
+			gameRecord.addMove(move);
+			rules.doMove(state, move);
+			if (rules.checkWimCondition(state, winner))
+				break;
+			keys.push_back(Gameplay::positionKey(state));
+		}
+
+		if (!settings.recordDirectory.empty())
+		{
+			gameRecord.setWinner(winner);
+			gameRecord.save(settings.recordDirectory + "/game-" + std::to_string(game) + ".fpgr");
+		}
+
+		for (TrainingRecord& record : gameRecords)
+		{
+			if (winner == Player::NoPlayer) record.result = 0;
+			else record.result = (static_cast<Player>(record.sideToMove) == winner) ? 1 : -1;
+		}
+
+		writer.write(gameRecords.data(), gameRecords.size());
+		if (winner != Player::NoPlayer) {
+			decisiveGames++;
+		}
+	}
+
+	writer.close();
+	records += writer.getRecordsWritten();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "TrainingData.h"
+#include "GameRecord.h"
+#include <atomic>
+#include <string>
+/**
+ * @file SelfPlay.h
+ * @brief Headless self-play generator producing labelled training positions.
+ */
+
+/**
+ * @struct SelfPlaySettings
+ * @brief Options for one self-play run.
+ */
+struct SelfPlaySettings {
+	int games{ 1000 };                       ///< Games to play in total
+	int depth{ 2 };                          ///< chooseBestMove depth for both sides
+	int threads{ 1 };                        ///< Worker threads, each writes its own shards
+	int randomPlies{ 4 };                    ///< Random moves after the random placement, not recorded
+	int maxPlies{ 100 };                     ///< Longer games are scored as a draw
+	int repetitions{ 3 };                    ///< A position seen this often ends the game as a draw, 0 to never
+	std::string outputPrefix{ "selfplay" };  ///< Shards are written to prefix-tN-NNNN.bin
+	std::size_t recordsPerShard{ 1 << 20 };  ///< 32 MB shards
+	std::size_t bufferRecords{ 4096 };       ///< Records held in memory per thread
+	unsigned int seed{ 1 };                  ///< Game g uses seed + g, whichever thread plays it
+	std::string recordDirectory;             ///< When set, every game is also saved there as game-N.fpgr
+};
+
+/**
+ * @class SelfPlay
+ * @brief Plays the minimax AI against itself on every core and streams each
+ *        searched position, its score and the game result to binary shards.
+ */
+class SelfPlay
+{
+public:
+	/**
+	 * @brief Runs all games and prints a summary.
+	 * @return Number of records written.
+	 */
+	static std::size_t run(const SelfPlaySettings& settings);
+
+private:
+	/**
+	 * @brief Takes game numbers from nextGame until all games are played.
+	 */
+	static void worker(const SelfPlaySettings& settings, int thread, std::atomic<int>& nextGame,
+		std::atomic<std::size_t>& records, std::atomic<int>& decisiveGames);
+};
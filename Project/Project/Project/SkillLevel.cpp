@@ -0,0 +1,118 @@
+#include "SkillLevel.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+/// Nodes per move at level 0.
+static const std::uint64_t MIN_NODE_BUDGET = 64;
+
+/// Most noise added to a score, a line one piece short of a win (EvalWeights::threat).
+static const int MAX_NOISE = 100;
+
+SkillLevel::SkillLevel(int level) : m_level(MAX_LEVEL), m_rng(std::random_device{}()), m_nodesSearched(0)
+{
+	setLevel(level);
+}
+
+void SkillLevel::setLevel(int level)
+{
+	m_level = std::clamp(level, 0, MAX_LEVEL);
+}
+
+int SkillLevel::getLevel() const
+{
+	return m_level;
+}
+
+bool SkillLevel::isEnabled() const
+{
+	return m_level < MAX_LEVEL;
+}
+
+/**
+ * @brief Odd levels sit halfway between their neighbours.
+ */
+std::uint64_t SkillLevel::getNodeBudget() const
+{
+	std::uint64_t budget = MIN_NODE_BUDGET << (m_level / 2);
+	return (m_level % 2) ? budget + budget / 2 : budget;
+}
+
+int SkillLevel::getMaxDepth() const
+{
+	return 1 + m_level;
+}
+
+void SkillLevel::setSeed(unsigned int seed)
+{
+	m_rng.seed(seed);
+}
+
+/**
+ * @brief Depth d is chooseBestMoves(d - 1), as in EngineProtocol. An iteration the
+ *        budget cuts short is thrown away, its lines are missing the moves not reached.
+ */
+Move SkillLevel::chooseMove(Gameplay& rules, const Boardstate& state, const SearchLimits& limits)
+{
+	const std::uint64_t budget = (limits.nodes != 0) ? std::min(limits.nodes, getNodeBudget()) : getNodeBudget();
+	std::vector<ScoredMove> lines;
+	m_nodesSearched = 0;
+
+	for (int depth = 1; depth <= getMaxDepth(); ++depth)
+	{
+		SearchLimits iteration = limits;
+		iteration.nodes = 0;
+		if (depth > 1) {
+			if (m_nodesSearched >= budget)
+				break;
+			iteration.nodes = budget - m_nodesSearched;
+		}
+		rules.setSearchLimits(iteration);
+
+		std::vector<ScoredMove> found = rules.chooseBestMoves(state, depth - 1, LINES);
+		m_nodesSearched += rules.getNodesEvaluated();
+
+		if (rules.wasStopped()) {
+			if (lines.empty()) lines = found;
+			break;
+		}
+
+		lines = found;
+		if (lines.empty() || std::abs(lines.front().score) >= UNLIMITED_POWER)
+			break;
+	}
+
+	rules.setSearchLimits(limits);
+	return lines.empty() ? Move() : pick(lines);
+}
+
+std::uint64_t SkillLevel::getNodesSearched() const
+{
+	return m_nodesSearched;
+}
+
+/**
+ * @brief Each line scores its own score, plus weakness/128 of its gap to the best line,
+ *        plus up to weakness/128 of the noise. The noise is the spread of the lines, so
+ *        moves of about the same worth get mixed up and a far worse one does not.
+ */
+Move SkillLevel::pick(const std::vector<ScoredMove>& lines)
+{
+	const int top = lines.front().score;
+	const int noise = std::min(top - lines.back().score, MAX_NOISE);
+	const int weakness = 120 - 2 * m_level;
+
+	Move chosen = lines.front().move;
+	long long bestPushed = std::numeric_limits<long long>::min();
+	for (const ScoredMove& line : lines)
+	{
+		const long long push = (static_cast<long long>(weakness) * (top - line.score)
+			+ static_cast<long long>(noise) * static_cast<int>(m_rng() % weakness)) / 128;
+		if (line.score + push > bestPushed) {
+			bestPushed = line.score + push;
+			chosen = line.move;
+		}
+	}
+
+	return chosen;
+}
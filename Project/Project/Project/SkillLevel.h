@@ -0,0 +1,78 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+#include <random>
+#include <vector>
+/**
+ * @file SkillLevel.h
+ * @brief Weaker players for hosting, each costing a fixed number of nodes per move.
+ */
+
+/**
+ * @class SkillLevel
+ * @brief Plays at a level from 0 to MAX_LEVEL, where MAX_LEVEL is full strength.
+ *
+ * Below full strength a move is a multi-PV search deepened only as far as the
+ * level's node budget reaches, whatever the position. The move played is then
+ * picked from the lines after noise is added to their scores: the lower the level,
+ * the smaller the gaps between the lines look and the larger the noise, so weak
+ * levels often play the second or third best move but rarely throw away a win.
+ * The budget, not the clock, bounds the work, so a level costs the same on a busy
+ * server as on an idle one.
+ */
+class SkillLevel
+{
+public:
+	static constexpr int MAX_LEVEL = 20;
+
+	/// Moves each search scores, the pick is made among them.
+	static constexpr int LINES = 4;
+
+	explicit SkillLevel(int level = MAX_LEVEL);
+
+	void setLevel(int level);
+	int getLevel() const;
+
+	/**
+	 * @brief False at MAX_LEVEL, the caller searches as usual.
+	 */
+	bool isEnabled() const;
+
+	/**
+	 * @brief Nodes a move may use: 64 at level 0, doubling every two levels.
+	 */
+	std::uint64_t getNodeBudget() const;
+
+	/**
+	 * @brief Deepest iteration, in plies: 1 + level.
+	 */
+	int getMaxDepth() const;
+
+	void setSeed(unsigned int seed);
+
+	/**
+	 * @brief Deepens a multi-PV search until the budget is spent and picks a move from
+	 *        the last iteration that finished. The first iteration always finishes unless
+	 *        limits stop it, so there is a move to pick from.
+	 * @param rules Searches the move, its limits are left as limits afterwards.
+	 * @param limits Deadline and stop flag of the caller. A node limit below the budget
+	 *        replaces it.
+	 * @return The move, or an invalid Move if limits stopped the search before any root move.
+	 */
+	Move chooseMove(Gameplay& rules, const Boardstate& state, const SearchLimits& limits);
+
+	/**
+	 * @brief Nodes the last chooseMove searched.
+	 */
+	std::uint64_t getNodesSearched() const;
+
+	/**
+	 * @brief Picks one of the lines, best first, with the level's noise.
+	 */
+	Move pick(const std::vector<ScoredMove>& lines);
+
+private:
+	int m_level;
+	std::mt19937 m_rng;
+	std::uint64_t m_nodesSearched;
+};
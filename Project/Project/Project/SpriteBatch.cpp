@@ -0,0 +1,138 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * @brief Stacks the piece sheets on top of each other and adds a white block below them.
+ *        Each sheet holds the Player 1 frame on the left and the Player 2 frame on the right.
+ */
+bool SpriteBatch::loadAtlas()
+{
+	const AnimalType types[3] = { AnimalType::Frog, AnimalType::Snake, AnimalType::Donkey };
+	const char* files[3] = { "ASSETS/IMAGES/frog.png", "ASSETS/IMAGES/snake.png", "ASSETS/IMAGES/donkey.png" };
+
+	sf::Image sheets[3];
+	unsigned int width = 0, height = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (!sheets[i].loadFromFile(files[i])) {
+			std::cout << "no atlas image loaded: " << files[i] << "\n";
+			return false;
+		}
+		width = std::max(width, sheets[i].getSize().x);
+		height += sheets[i].getSize().y;
+	}
+
+	// Two pixel rows for the white block the grid lines sample from
+	sf::Image atlas;
+	atlas.resize({ width, height + 2 }, sf::Color::Transparent);
+
+	unsigned int top = 0;
+	for (int i = 0; i < 3; ++i)
+	{
+		if (!atlas.copy(sheets[i], { 0, top })) {
+			return false;
+		}
+
+		sf::Vector2i frameSize(sheets[i].getSize().x / 2, sheets[i].getSize().y);
+		m_frames[types[i]][Player::Player1] = sf::IntRect({ 0, static_cast<int>(top) }, frameSize);
+		m_frames[types[i]][Player::Player2] = sf::IntRect({ frameSize.x, static_cast<int>(top) }, frameSize);
+		top += sheets[i].getSize().y;
+	}
+
+	for (unsigned int x = 0; x < 2; ++x) {
+		for (unsigned int y = 0; y < 2; ++y) {
+			atlas.setPixel({ x, height + y }, sf::Color::White);
+		}
+	}
+	m_whitePixel = { 1.f, height + 1.f };
+
+	if (!m_atlas.loadFromImage(atlas)) {
+		return false;
+	}
+
+	m_loaded = true;
+	return true;
+}
+
+bool SpriteBatch::isLoaded() const
+{
+	return m_loaded;
+}
+
+void SpriteBatch::clear()
+{
+	m_vertices.clear();
+}
+
+/**
+ * @brief One-pixel lines along the inside edge of every cell, like the old outlined rectangles.
+ */
+void SpriteBatch::addGrid(const Board& board)
+{
+	const float cellSize = board.getCellSize();
+	const sf::Color lineColor = sf::Color::White;
+
+	for (int row = 0; row < board.getSize(); ++row)
+	{
+		for (int col = 0; col < board.getSize(); ++col)
+		{
+			sf::Vector2f center = board.getCellCenter(row, col);
+			sf::Vector2f corner(center.x - cellSize / 2.f, center.y - cellSize / 2.f);
+
+			addQuad(corner, { cellSize, 1.f }, m_whitePixel, {}, lineColor);
+			addQuad({ corner.x, corner.y + cellSize - 1.f }, { cellSize, 1.f }, m_whitePixel, {}, lineColor);
+			addQuad({ corner.x, corner.y + 1.f }, { 1.f, cellSize - 2.f }, m_whitePixel, {}, lineColor);
+			addQuad({ corner.x + cellSize - 1.f, corner.y + 1.f }, { 1.f, cellSize - 2.f }, m_whitePixel, {}, lineColor);
+		}
+	}
+}
+
+/**
+ * @brief Piece quad, the frame scaled to 80% of a cell and centred on center.
+ */
+void SpriteBatch::addPiece(Player owner, AnimalType type, sf::Vector2f center, float cellSize)
+{
+	if (owner == Player::NoPlayer || type == AnimalType::NoType)
+		return;
+
+	const sf::IntRect& frame = m_frames[type][owner];
+	sf::Vector2f frameSize(static_cast<float>(frame.size.x), static_cast<float>(frame.size.y));
+
+	float scale = (cellSize * 0.8f) / std::max(frameSize.x, frameSize.y);
+	sf::Vector2f size(frameSize.x * scale, frameSize.y * scale);
+
+	addQuad({ center.x - size.x / 2.f, center.y - size.y / 2.f }, size,
+		sf::Vector2f(frame.position), frameSize, sf::Color::White);
+}
+
+void SpriteBatch::draw(sf::RenderWindow& window) const
+{
+	window.draw(m_vertices, &m_atlas);
+}
+
+std::size_t SpriteBatch::getQuadCount() const
+{
+	return m_vertices.getVertexCount() / 6;
+}
+
+void SpriteBatch::addQuad(sf::Vector2f position, sf::Vector2f size, sf::Vector2f texturePosition, sf::Vector2f textureSize, sf::Color color)
+{
+	const sf::Vector2f topLeft = position;
+	const sf::Vector2f topRight(position.x + size.x, position.y);
+	const sf::Vector2f bottomLeft(position.x, position.y + size.y);
+	const sf::Vector2f bottomRight(position.x + size.x, position.y + size.y);
+
+	const sf::Vector2f textureTopLeft = texturePosition;
+	const sf::Vector2f textureTopRight(texturePosition.x + textureSize.x, texturePosition.y);
+	const sf::Vector2f textureBottomLeft(texturePosition.x, texturePosition.y + textureSize.y);
+	const sf::Vector2f textureBottomRight(texturePosition.x + textureSize.x, texturePosition.y + textureSize.y);
+
+	m_vertices.append({ topLeft, color, textureTopLeft });
+	m_vertices.append({ topRight, color, textureTopRight });
+	m_vertices.append({ bottomLeft, color, textureBottomLeft });
+
+	m_vertices.append({ topRight, color, textureTopRight });
+	m_vertices.append({ bottomRight, color, textureBottomRight });
+	m_vertices.append({ bottomLeft, color, textureBottomLeft });
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "Board.h"
+/**
+ * @file SpriteBatch.h
+ * @brief Draws the board grid and every piece with one draw call from a sprite atlas.
+ */
+
+/**
+ * @class SpriteBatch
+ * @brief Quads for the grid and the pieces, all textured from one atlas.
+ *
+ * The frog, snake and donkey sheets are packed into one texture, with a white
+ * block for the untextured grid lines. The caller clears and refills the
+ * batch only when the board or layout changes; drawing it is then one call
+ * no matter how many pieces there are.
+ */
+class SpriteBatch
+{
+public:
+	/**
+	 * @brief Packs the three piece sheets into the atlas texture.
+	 * @return false if an image could not be loaded, the batch must not be used then.
+	 */
+	bool loadAtlas();
+
+	/**
+	 * @brief True once loadAtlas has succeeded.
+	 */
+	bool isLoaded() const;
+
+	/**
+	 * @brief Removes every quad.
+	 */
+	void clear();
+
+	/**
+	 * @brief Adds the cell outlines of the board at its current layout.
+	 */
+	void addGrid(const Board& board);
+
+	/**
+	 * @brief Adds one piece, sized the same way Animal scales its sprite.
+	 * @param owner Player whose frame to use.
+	 * @param type Animal to draw.
+	 * @param center Screen position of the piece's centre.
+	 * @param cellSize Board cell size.
+	 */
+	void addPiece(Player owner, AnimalType type, sf::Vector2f center, float cellSize);
+
+	/**
+	 * @brief Draws every quad with a single draw call.
+	 */
+	void draw(sf::RenderWindow& window) const;
+
+	/**
+	 * @brief Number of quads in the batch.
+	 */
+	std::size_t getQuadCount() const;
+
+private:
+	/**
+	 * @brief Appends two triangles covering a screen rectangle.
+	 */
+	void addQuad(sf::Vector2f position, sf::Vector2f size, sf::Vector2f texturePosition, sf::Vector2f textureSize, sf::Color color);
+
+	sf::Texture m_atlas;
+	sf::VertexArray m_vertices{ sf::PrimitiveType::Triangles };
+	sf::IntRect m_frames[4][3]; ///< Atlas rectangle per [AnimalType][Player]
+	sf::Vector2f m_whitePixel;  ///< Texture coordinate of the white block
+	bool m_loaded{ false };
+};
@@ -0,0 +1,77 @@
+#include "TextureCache.h"
+#include <iostream>
+
+int TextureCache::s_decodeCount = 0;
+
+/**
+ * @brief The cached textures by file path.
+ */
+std::map<std::string, TextureCache::Handle>& TextureCache::entries()
+{
+	static std::map<std::string, Handle> textures;
+	return textures;
+}
+
+/**
+ * @brief Returns the cached texture, decoding the file on the first request. A file that
+ *        fails to load is cached as nullptr, so a bad path is only read and reported once.
+ */
+TextureCache::Handle TextureCache::get(const std::string& path)
+{
+	std::map<std::string, Handle>& textures = entries();
+
+	auto found = textures.find(path);
+	if (found != textures.end())
+		return found->second;
+
+	auto texture = std::make_shared<sf::Texture>();
+	s_decodeCount++;
+	if (!texture->loadFromFile(path)) {
+		std::cout << "no texture loaded: " << path << "\n";
+		textures[path] = nullptr;
+		return nullptr;
+	}
+
+	textures[path] = texture;
+	return texture;
+}
+
+/**
+ * @brief Shared empty texture.
+ */
+const sf::Texture& TextureCache::placeholder()
+{
+	static const sf::Texture empty;
+	return empty;
+}
+
+/**
+ * @brief Releases textures with no handles outside the cache. Failed loads hold no
+ *        texture (use_count 0) and stay cached.
+ */
+std::size_t TextureCache::releaseUnused()
+{
+	std::map<std::string, Handle>& textures = entries();
+	std::size_t released = 0;
+
+	for (auto it = textures.begin(); it != textures.end();)
+	{
+		if (it->second.use_count() == 1) {
+			it = textures.erase(it);
+			released++;
+		}
+		else {
+			++it;
+		}
+	}
+
+	return released;
+}
+
+/**
+ * @brief Total decodes, failed loads included.
+ */
+int TextureCache::getDecodeCount()
+{
+	return s_decodeCount;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <map>
+#include <memory>
+#include <string>
+/**
+ * @file TextureCache.h
+ * @brief Process-wide cache so each image file is decoded once and shared by every sprite.
+ */
+
+/**
+ * @class TextureCache
+ * @brief Loads textures on first request and hands out shared, reference-counted handles.
+ *
+ * Holding a handle keeps the texture alive, so copying an Animal only copies a
+ * pointer. Textures belong to the render thread, so the cache is only used from it.
+ */
+class TextureCache
+{
+public:
+	using Handle = std::shared_ptr<const sf::Texture>;
+
+	/**
+	 * @brief Gets the texture for an image file, decoding it only the first time.
+	 *        A failed load is remembered too, later requests for it return nullptr at once.
+	 * @param path Image file path.
+	 * @return Shared texture, or nullptr if the file could not be loaded.
+	 */
+	static Handle get(const std::string& path);
+
+	/**
+	 * @brief Empty texture for sprites that have nothing to show yet.
+	 */
+	static const sf::Texture& placeholder();
+
+	/**
+	 * @brief Drops textures that nothing but the cache holds on to.
+	 * @return Number of textures released.
+	 */
+	static std::size_t releaseUnused();
+
+	/**
+	 * @brief Number of image files decoded since the program started.
+	 */
+	static int getDecodeCount();
+
+private:
+	static std::map<std::string, Handle>& entries();
+
+	static int s_decodeCount;
+};
@@ -0,0 +1,95 @@
+#include "TimeManager.h"
+#include <algorithm>
+
+/// Moves the clock is shared out over, at most and at least.
+static const int MAX_MOVES_LEFT = 30;
+static const int MIN_MOVES_LEFT = 8;
+
+/// Kept back on the clock for drawing frames and the move itself.
+static const int OVERHEAD_MS = 50;
+
+TimeManager::TimeManager(const TimeControl& control) : m_control(control), m_remainingMs{},
+	m_player(Player::NoPlayer), m_optimumMs(0), m_maximumMs(0), m_stretch(1.0), m_instant(false)
+{
+	reset();
+}
+
+void TimeManager::reset()
+{
+	for (int& remaining : m_remainingMs) {
+		remaining = m_control.baseMs;
+	}
+}
+
+bool TimeManager::isEnabled() const
+{
+	return m_control.baseMs > 0;
+}
+
+int TimeManager::getRemainingMs(Player player) const
+{
+	return m_remainingMs[player];
+}
+
+/**
+ * @brief The phase of the game sets how many moves the clock has to last: near the
+ *        draw rule's limit there are few left, so each gets more.
+ */
+void TimeManager::startMove(Player player, int legalMoves, int movementPlies, int maxMovementPlies, bool threat)
+{
+	m_player = player;
+	m_start = std::chrono::steady_clock::now();
+	m_instant = legalMoves <= 1;
+	m_stretch = 1.0;
+
+	int movesLeft = MAX_MOVES_LEFT;
+	if (maxMovementPlies > 0) {
+		movesLeft = std::clamp((maxMovementPlies - movementPlies + 1) / 2, MIN_MOVES_LEFT, MAX_MOVES_LEFT);
+	}
+
+	const int available = std::max(m_remainingMs[player] - OVERHEAD_MS, 0);
+	m_optimumMs = available / movesLeft + m_control.incrementMs * 3 / 4;
+	if (threat) {
+		m_optimumMs = m_optimumMs * 3 / 2;
+	}
+
+	// Never a big bite of what is left, however the move goes
+	m_maximumMs = std::min(m_optimumMs * 4, available / 3 + m_control.incrementMs / 2);
+	m_maximumMs = std::max(m_maximumMs, 1);
+	m_optimumMs = std::clamp(m_optimumMs, 1, m_maximumMs);
+}
+
+bool TimeManager::isInstant() const
+{
+	return m_instant;
+}
+
+std::chrono::steady_clock::time_point TimeManager::getHardDeadline() const
+{
+	return m_start + std::chrono::milliseconds(m_maximumMs);
+}
+
+/**
+ * @brief Each iteration takes a few times longer than all before it, so the next one is
+ *        only started in the first half of the budget.
+ */
+bool TimeManager::shouldDeepen(bool bestMoveChanged)
+{
+	m_stretch = bestMoveChanged ? std::min(m_stretch * 1.5, 3.0) : std::max(m_stretch * 0.9, 0.5);
+
+	const double target = std::min(m_optimumMs * m_stretch, static_cast<double>(m_maximumMs));
+	return elapsedMs() < target / 2;
+}
+
+int TimeManager::endMove()
+{
+	const int used = elapsedMs();
+	int& remaining = m_remainingMs[m_player];
+	remaining = std::max(remaining - used, 0) + m_control.incrementMs;
+	return used;
+}
+
+int TimeManager::elapsedMs() const
+{
+	return static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_start).count());
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "GameTypes.h"
+#include <chrono>
+/**
+ * @file TimeManager.h
+ * @brief Game clocks for the AI players and how much of them each move gets.
+ */
+
+/**
+ * @struct TimeControl
+ * @brief Time each player starts with and gets back after every move.
+ */
+struct TimeControl {
+	int baseMs{ 60000 };      ///< Whole game, 0 for no clock (the AI searches a fixed depth)
+	int incrementMs{ 1000 };  ///< Added after each move
+};
+
+/**
+ * @class TimeManager
+ * @brief Keeps one clock per player and turns it into a budget for each search.
+ *
+ * A move gets its share of the clock for the moves likely left, which the draw
+ * rule's movement ply limit caps, plus most of the increment. A threat on the
+ * board earns more. While searching, a best move that changed between iterations
+ * stretches the budget and one that keeps standing shrinks it. A single legal
+ * move is played at once. No move ever goes past the hard limit.
+ */
+class TimeManager
+{
+public:
+	explicit TimeManager(const TimeControl& control = TimeControl());
+
+	/**
+	 * @brief Both clocks back to the base time.
+	 */
+	void reset();
+
+	/**
+	 * @brief False when playing without a clock.
+	 */
+	bool isEnabled() const;
+
+	int getRemainingMs(Player player) const;
+
+	/**
+	 * @brief Starts the player's clock and plans the move.
+	 * @param legalMoves Moves the player has, 1 makes isInstant true.
+	 * @param movementPlies Board moves played so far in the game.
+	 * @param maxMovementPlies Board moves before the game is a draw, 0 for no limit.
+	 * @param threat True if either side is one piece short of a line.
+	 */
+	void startMove(Player player, int legalMoves, int movementPlies, int maxMovementPlies, bool threat);
+
+	/**
+	 * @brief True if the move is forced and needs no search.
+	 */
+	bool isInstant() const;
+
+	/**
+	 * @brief Time the search must stop by, whatever it is in the middle of.
+	 */
+	std::chrono::steady_clock::time_point getHardDeadline() const;
+
+	/**
+	 * @brief Called after each finished iteration.
+	 * @param bestMoveChanged True if this iteration's move differs from the last one's.
+	 * @return true if another, deeper iteration is likely to finish in time.
+	 */
+	bool shouldDeepen(bool bestMoveChanged);
+
+	/**
+	 * @brief Stops the clock, charges the time used and adds the increment.
+	 * @return Milliseconds the move took.
+	 */
+	int endMove();
+
+private:
+	/// Milliseconds since startMove.
+	int elapsedMs() const;
+
+	TimeControl m_control;
+	int m_remainingMs[3]; ///< Per Player
+	Player m_player;
+	std::chrono::steady_clock::time_point m_start;
+	int m_optimumMs;      ///< Planned time for the move
+	int m_maximumMs;      ///< Hard limit for the move
+	double m_stretch;     ///< How far the plan is scaled by the search so far
+	bool m_instant;
+};
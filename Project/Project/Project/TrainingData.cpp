@@ -0,0 +1,328 @@
+#include "TrainingData.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char SHARD_MAGIC[4] = { 'F', 'P', 'S', 'P' };
+static const std::uint32_t SHARD_VERSION = 1;
+
+/**
+ * @brief Packs the grid into nibbles and stores the score for the side to move.
+ */
+TrainingRecord TrainingRecord::fromBoardstate(const Boardstate& state, int score, int ply, std::uint32_t game)
+{
+	TrainingRecord record{};
+
+	for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+	{
+		const PieceState& piece = state.grid[cell / BOARD_SIZE][cell % BOARD_SIZE];
+		std::uint8_t nibble = static_cast<std::uint8_t>(piece.owner | (piece.type << 2));
+		record.cells[cell / 2] |= nibble << ((cell % 2) * 4);
+	}
+
+	record.score = score;
+	record.sideToMove = static_cast<std::uint8_t>(state.currentPlayer);
+	record.ply = static_cast<std::uint16_t>(ply);
+	record.game = game;
+	return record;
+}
+
+/**
+ * @brief Unpacks the nibbles back into a Boardstate.
+ */
+Boardstate TrainingRecord::toBoardstate() const
+{
+	Boardstate state;
+
+	for (int cell = 0; cell < BOARD_SIZE * BOARD_SIZE; ++cell)
+	{
+		int nibble = (cells[cell / 2] >> ((cell % 2) * 4)) & 0xF;
+		state.grid[cell / BOARD_SIZE][cell % BOARD_SIZE] = { static_cast<Player>(nibble & 3), static_cast<AnimalType>(nibble >> 2) };
+	}
+
+	state.currentPlayer = static_cast<Player>(sideToMove);
+	return state;
+}
+
+// ------------ ShardWriter ------------
+
+/**
+ * @brief Sets up the writer, the first shard is opened on the first flush.
+ */
+ShardWriter::ShardWriter(const std::string& prefix, std::size_t recordsPerShard, std::size_t bufferRecords)
+	: m_prefix(prefix), m_recordsPerShard(std::max<std::size_t>(1, recordsPerShard)),
+	m_bufferRecords(std::max<std::size_t>(1, bufferRecords)), m_file(nullptr), m_shardIndex(0),
+	m_recordsInShard(0), m_recordsWritten(0), m_failed(false)
+{
+	m_buffer.reserve(m_bufferRecords);
+}
+
+/**
+ * @brief Flushes anything still buffered.
+ */
+ShardWriter::~ShardWriter()
+{
+	close();
+}
+
+/**
+ * @brief Copies records into the buffer, flushing each time it fills.
+ */
+void ShardWriter::write(const TrainingRecord* records, std::size_t count)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		m_buffer.push_back(records[i]);
+		if (m_buffer.size() >= m_bufferRecords) {
+			flush();
+		}
+	}
+}
+
+/**
+ * @brief Writes the buffer, splitting it across shards at the shard size limit.
+ *        After a failed open or write nothing more is written, the records left are dropped.
+ */
+void ShardWriter::flush()
+{
+	std::size_t written = 0;
+
+	while (written < m_buffer.size() && !m_failed)
+	{
+		if (!m_file || m_recordsInShard >= m_recordsPerShard) {
+			if (!openNextShard()) {
+				m_failed = true;
+				break;
+			}
+		}
+
+		std::size_t count = std::min(m_buffer.size() - written, m_recordsPerShard - m_recordsInShard);
+		std::size_t done = std::fwrite(m_buffer.data() + written, sizeof(TrainingRecord), count, m_file);
+
+		written += done;
+		m_recordsInShard += done;
+		m_recordsWritten += done;
+		if (done != count) {
+			std::cout << "Error writing shard " << m_prefix << "-" << (m_shardIndex - 1) << ", "
+				<< (m_buffer.size() - written) << " positions dropped\n";
+			m_failed = true;
+		}
+	}
+
+	m_buffer.clear();
+}
+
+/**
+ * @brief Closes the current shard and starts prefix-NNNN.bin with a fresh header.
+ */
+bool ShardWriter::openNextShard()
+{
+	if (m_file) {
+		std::fclose(m_file);
+	}
+
+	char suffix[16];
+	std::snprintf(suffix, sizeof(suffix), "-%04d.bin", m_shardIndex++);
+	std::string path = m_prefix + suffix;
+
+	m_file = std::fopen(path.c_str(), "wb");
+	m_recordsInShard = 0;
+	if (!m_file) {
+		std::cout << "Error opening shard " << path << "\n";
+		return false;
+	}
+
+	ShardHeader header{};
+	std::memcpy(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC));
+	header.version = SHARD_VERSION;
+	header.recordSize = sizeof(TrainingRecord);
+	header.boardSize = BOARD_SIZE;
+	if (std::fwrite(&header, sizeof(header), 1, m_file) != 1) {
+		std::cout << "Error writing shard " << path << "\n";
+		std::fclose(m_file);
+		m_file = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Writes out the buffer and closes the shard.
+ */
+void ShardWriter::close()
+{
+	flush();
+	if (m_file) {
+		// The last records may only reach the disk here
+		if (std::fclose(m_file) != 0) {
+			std::cout << "Error closing shard " << m_prefix << "-" << (m_shardIndex - 1) << "\n";
+			m_failed = true;
+		}
+		m_file = nullptr;
+	}
+}
+
+bool ShardWriter::hasFailed() const
+{
+	return m_failed;
+}
+
+/**
+ * @brief Records fwrite took so far.
+ */
+std::size_t ShardWriter::getRecordsWritten() const
+{
+	return m_recordsWritten;
+}
+
+// ------------ ShardReader ------------
+
+ShardReader::ShardReader() : m_data(nullptr), m_length(0), m_count(0)
+#if defined(_WIN32)
+	, m_fileHandle(nullptr), m_mappingHandle(nullptr)
+#endif
+{
+}
+
+ShardReader::~ShardReader()
+{
+	close();
+}
+
+/**
+ * @brief Maps the whole file read-only and validates the header.
+ */
+bool ShardReader::open(const std::string& path)
+{
+	close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(file, &fileSize);
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view) {
+		if (mapping) CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	m_fileHandle = file;
+	m_mappingHandle = mapping;
+	m_length = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+	int file = ::open(path.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat info;
+	if (fstat(file, &info) != 0 || info.st_size == 0) {
+		::close(file);
+		return false;
+	}
+	void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+	if (view == MAP_FAILED) {
+		return false;
+	}
+	m_length = static_cast<std::size_t>(info.st_size);
+#endif
+	m_data = static_cast<const unsigned char*>(view);
+
+	ShardHeader header{};
+	if (m_length >= sizeof(header)) {
+		std::memcpy(&header, m_data, sizeof(header));
+	}
+	if (m_length < sizeof(header) || std::memcmp(header.magic, SHARD_MAGIC, sizeof(SHARD_MAGIC)) != 0
+		|| header.version != SHARD_VERSION || header.recordSize != sizeof(TrainingRecord) || header.boardSize != BOARD_SIZE)
+	{
+		std::cout << "Error reading shard " << path << ": wrong format or board size\n";
+		close();
+		return false;
+	}
+
+	m_count = (m_length - sizeof(ShardHeader)) / sizeof(TrainingRecord);
+	return true;
+}
+
+/**
+ * @brief Releases the mapping.
+ */
+void ShardReader::close()
+{
+	if (!m_data) {
+		return;
+	}
+
+#if defined(_WIN32)
+	UnmapViewOfFile(m_data);
+	CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+	CloseHandle(static_cast<HANDLE>(m_fileHandle));
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+#else
+	munmap(const_cast<unsigned char*>(m_data), m_length);
+#endif
+
+	m_data = nullptr;
+	m_length = 0;
+	m_count = 0;
+}
+
+/**
+ * @brief Records start straight after the header.
+ */
+const TrainingRecord* ShardReader::records() const
+{
+	return m_data ? reinterpret_cast<const TrainingRecord*>(m_data + sizeof(ShardHeader)) : nullptr;
+}
+
+/**
+ * @brief Number of whole records in the mapping.
+ */
+std::size_t ShardReader::size() const
+{
+	return m_count;
+}
+
+/**
+ * @brief Maps every shard and shuffles pointers to the records, the records themselves stay in the mappings.
+ */
+std::vector<const TrainingRecord*> ShardReader::openShuffled(const std::vector<std::string>& paths,
+	std::vector<std::unique_ptr<ShardReader>>& readers, unsigned int seed)
+{
+	std::vector<const TrainingRecord*> order;
+
+	for (const std::string& path : paths)
+	{
+		auto reader = std::make_unique<ShardReader>();
+		if (!reader->open(path)) {
+			continue;
+		}
+
+		const TrainingRecord* records = reader->records();
+		for (std::size_t i = 0; i < reader->size(); ++i) {
+			order.push_back(records + i);
+		}
+		readers.push_back(std::move(reader));
+	}
+
+	std::mt19937 rng(seed);
+	std::shuffle(order.begin(), order.end(), rng);
+	return order;
+}
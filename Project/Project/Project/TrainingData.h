@@ -0,0 +1,162 @@
+#pragma once
+#include "Gameplay.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+/**
+ * @file TrainingData.h
+ * @brief Fixed-width binary training records, shard writer and memory mapped shard reader.
+ */
+
+/**
+ * @struct TrainingRecord
+ * @brief One labelled position, exactly 32 bytes so a shard is a plain array.
+ *
+ * Cells are packed two per byte, low nibble first: bits 0-1 owner, bits 2-3 animal type.
+ */
+struct TrainingRecord {
+	std::uint8_t cells[16];   ///< BOARD_SIZE * BOARD_SIZE cells, 4 bits each
+	std::int32_t score;       ///< Search score for the side to move
+	std::int8_t result;       ///< Final result for the side to move: 1 win, 0 draw, -1 loss
+	std::uint8_t sideToMove;  ///< Player value of the side to move
+	std::uint16_t ply;        ///< Moves played since the start position
+	std::uint32_t game;       ///< Game number, unique within a shard
+	std::uint8_t reserved[4];
+
+	/**
+	 * @brief Packs a board and its search score. The result is filled in when the game ends.
+	 */
+	static TrainingRecord fromBoardstate(const Boardstate& state, int score, int ply, std::uint32_t game);
+
+	/**
+	 * @brief Unpacks the board.
+	 */
+	Boardstate toBoardstate() const;
+};
+static_assert(sizeof(TrainingRecord) == 32, "TrainingRecord must stay 32 bytes");
+static_assert(BOARD_SIZE * BOARD_SIZE <= 32, "TrainingRecord packs at most 32 cells");
+
+/**
+ * @struct ShardHeader
+ * @brief First 16 bytes of every shard, records follow immediately.
+ */
+struct ShardHeader {
+	char magic[4];              ///< "FPSP"
+	std::uint32_t version;
+	std::uint32_t recordSize;   ///< sizeof(TrainingRecord)
+	std::uint32_t boardSize;
+};
+static_assert(sizeof(ShardHeader) == 16, "Records must start 16 byte aligned");
+
+/**
+ * @class ShardWriter
+ * @brief Appends records to numbered shard files through a fixed-size buffer.
+ *
+ * Memory use is capped at bufferRecords records no matter how many are written.
+ * When a shard reaches recordsPerShard records the next one is started.
+ */
+class ShardWriter
+{
+public:
+	/**
+	 * @param prefix Shard files are named prefix-0000.bin, prefix-0001.bin, ...
+	 * @param recordsPerShard Records before starting a new file.
+	 * @param bufferRecords Records held in memory before a write.
+	 */
+	ShardWriter(const std::string& prefix, std::size_t recordsPerShard, std::size_t bufferRecords);
+	~ShardWriter();
+
+	ShardWriter(const ShardWriter&) = delete;
+	ShardWriter& operator=(const ShardWriter&) = delete;
+
+	/**
+	 * @brief Queues records, writing the buffer out whenever it fills.
+	 */
+	void write(const TrainingRecord* records, std::size_t count);
+
+	/**
+	 * @brief Writes the buffer and closes the current shard.
+	 */
+	void close();
+
+	/**
+	 * @brief Total records written so far, not counting any a failure dropped.
+	 */
+	std::size_t getRecordsWritten() const;
+
+	/**
+	 * @brief True once a shard could not be opened or written. The writer stops there
+	 *        and drops what it is given after, having reported the error.
+	 */
+	bool hasFailed() const;
+
+private:
+	void flush();
+	bool openNextShard();
+
+	std::string m_prefix;
+	std::size_t m_recordsPerShard;
+	std::vector<TrainingRecord> m_buffer;
+	std::size_t m_bufferRecords;
+
+	std::FILE* m_file;
+	int m_shardIndex;
+	std::size_t m_recordsInShard;
+	std::size_t m_recordsWritten;
+	bool m_failed;
+};
+
+/**
+ * @class ShardReader
+ * @brief Maps one shard file into memory and serves its records in place.
+ */
+class ShardReader
+{
+public:
+	ShardReader();
+	~ShardReader();
+
+	ShardReader(const ShardReader&) = delete;
+	ShardReader& operator=(const ShardReader&) = delete;
+
+	/**
+	 * @brief Maps a shard and checks its header.
+	 * @return false if the file is missing or was written for a different record layout or board size.
+	 */
+	bool open(const std::string& path);
+
+	/**
+	 * @brief Unmaps the file.
+	 */
+	void close();
+
+	/**
+	 * @brief Records in the shard, pointing straight into the mapping.
+	 */
+	const TrainingRecord* records() const;
+
+	/**
+	 * @brief Number of records in the shard.
+	 */
+	std::size_t size() const;
+
+	/**
+	 * @brief Maps every shard in paths and returns a shuffled order over all of them.
+	 * @param readers Filled with one open reader per shard that could be mapped.
+	 * @param seed Shuffle seed.
+	 * @return Pointers to every record, in random order.
+	 */
+	static std::vector<const TrainingRecord*> openShuffled(const std::vector<std::string>& paths,
+		std::vector<std::unique_ptr<ShardReader>>& readers, unsigned int seed);
+
+private:
+	const unsigned char* m_data;
+	std::size_t m_length;
+	std::size_t m_count;
+#if defined(_WIN32)
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+};
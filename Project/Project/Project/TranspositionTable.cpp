@@ -0,0 +1,100 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+
+/**
+ * @brief Score in the low 32 bits, then depth, bound and move.
+ */
+static std::uint64_t packData(int score, int depth, TranspositionTable::Bound bound, std::uint16_t move)
+{
+	return static_cast<std::uint32_t>(score) |
+		static_cast<std::uint64_t>(static_cast<std::uint8_t>(depth)) << 32 |
+		static_cast<std::uint64_t>(bound) << 40 |
+		static_cast<std::uint64_t>(move) << 48;
+}
+
+TranspositionTable::TranspositionTable(std::size_t megabytes) : m_capacity(0), m_mask(0)
+{
+	resize(megabytes);
+}
+
+/**
+ * @brief Largest power of two entries that fits in the requested size, at least one.
+ */
+void TranspositionTable::resize(std::size_t megabytes)
+{
+	std::size_t wanted = std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(Slot));
+	std::size_t entries = 1;
+	while (entries * 2 <= wanted) {
+		entries *= 2;
+	}
+
+	// Value-initialised, every slot starts empty
+	m_slots.reset(new Slot[entries]());
+	m_capacity = entries;
+	m_mask = entries - 1;
+}
+
+void TranspositionTable::clear()
+{
+	for (std::size_t i = 0; i < m_capacity; ++i)
+	{
+		m_slots[i].check.store(0, std::memory_order_relaxed);
+		m_slots[i].data.store(0, std::memory_order_relaxed);
+	}
+}
+
+bool TranspositionTable::probe(std::uint64_t key, TTEntry& entry) const
+{
+	const Slot& slot = m_slots[key & m_mask];
+	std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+	std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+
+	if ((check ^ data) != key)
+		return false;
+
+	entry.key = key;
+	entry.score = static_cast<std::int32_t>(static_cast<std::uint32_t>(data));
+	entry.depth = static_cast<std::int8_t>(data >> 32);
+	entry.bound = static_cast<std::uint8_t>(data >> 40);
+	entry.move = static_cast<std::uint16_t>(data >> 48);
+
+	return entry.bound != Bound::None;
+}
+
+/**
+ * @brief Depth-preferred replacement, except the same position is always refreshed.
+ */
+void TranspositionTable::store(std::uint64_t key, int score, int depth, Bound bound, std::uint16_t move)
+{
+	Slot& slot = m_slots[key & m_mask];
+	std::uint64_t oldData = slot.data.load(std::memory_order_relaxed);
+	std::uint64_t oldKey = slot.check.load(std::memory_order_relaxed) ^ oldData;
+	int oldDepth = static_cast<std::int8_t>(oldData >> 32);
+
+	if (oldData != 0 && oldKey != key && oldDepth > depth)
+		return;
+
+	// Keep the old best move when this search did not find one
+	if (move == 0 && oldKey == key) {
+		move = static_cast<std::uint16_t>(oldData >> 48);
+	}
+
+	std::uint64_t data = packData(score, depth, bound, move);
+	slot.check.store(key ^ data, std::memory_order_relaxed);
+	slot.data.store(data, std::memory_order_relaxed);
+}
+
+std::size_t TranspositionTable::getCapacity() const
+{
+	return m_capacity;
+}
+
+int TranspositionTable::getPermilleFull() const
+{
+	std::size_t sample = std::min<std::size_t>(1000, m_capacity);
+	int used = 0;
+	for (std::size_t i = 0; i < sample; ++i) {
+		used += m_slots[i].data.load(std::memory_order_relaxed) != 0;
+	}
+	return static_cast<int>(used * 1000 / sample);
+}
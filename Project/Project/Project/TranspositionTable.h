@@ -0,0 +1,158 @@
+#pragma once
+#include "GameTypes.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+/**
+ * @file TranspositionTable.h
+ * @brief Zobrist position keys and a fixed-size table of search results.
+ */
+
+/**
+ * @struct ZobristKeys
+ * @brief One random key per (cell, owner, animal type), per side to move and per
+ *        maximizing player. A position's key is the XOR of the keys that apply to it.
+ */
+template<int Size>
+struct ZobristKeys {
+	std::uint64_t piece[Size * Size][3][4]{}; ///< [cell][Player][AnimalType]
+	std::uint64_t sideToMove[3]{};            ///< [Player]
+	std::uint64_t maximizer[3]{};             ///< [Player], evaluateBoard scores depend on it
+};
+
+/**
+ * @brief Fills the key table from a fixed splitmix64 sequence, so keys never change between builds.
+ */
+template<int Size>
+constexpr ZobristKeys<Size> makeZobristKeys()
+{
+	ZobristKeys<Size> keys{};
+	std::uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+	auto next = [&seed]() {
+		seed += 0x9E3779B97F4A7C15ull;
+		std::uint64_t z = seed;
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	};
+
+	for (int cell = 0; cell < Size * Size; ++cell)
+		for (int owner = 1; owner < 3; ++owner)
+			for (int type = 1; type < 4; ++type)
+				keys.piece[cell][owner][type] = next();
+
+	for (int player = 1; player < 3; ++player)
+	{
+		keys.sideToMove[player] = next();
+		keys.maximizer[player] = next();
+	}
+
+	return keys;
+}
+
+/// One key table per board size.
+template<int Size>
+inline constexpr ZobristKeys<Size> ZOBRIST = makeZobristKeys<Size>();
+
+/**
+ * @struct TTEntry
+ * @brief One stored search result.
+ */
+struct TTEntry {
+	std::uint64_t key;
+	std::int32_t score;
+	std::int8_t depth;
+	std::uint8_t bound;
+	std::uint16_t move;   ///< Best move, packMove format, 0 if none
+};
+
+/**
+ * @brief Packs a move into 16 bits: (from cell * 64 + to cell) + 1, 0 is no move.
+ */
+inline std::uint16_t packMove(const Move& move, int size)
+{
+	if (!move.isValid())
+		return 0;
+	return static_cast<std::uint16_t>(((move.row1 * size + move.col1) << 6 | (move.row2 * size + move.col2)) + 1);
+}
+
+/**
+ * @brief Inverse of packMove, an invalid Move for 0.
+ */
+inline Move unpackMove(std::uint16_t packed, int size)
+{
+	if (packed == 0)
+		return Move();
+	int from = (packed - 1) >> 6;
+	int to = (packed - 1) & 63;
+	return Move(from / size, from % size, to / size, to % size);
+}
+
+/**
+ * @class TranspositionTable
+ * @brief Power-of-two array of entries indexed by the low bits of the key.
+ *
+ * A new result replaces the old one unless the old one is for the same slot,
+ * a different position and a deeper search. Safe to share between searching
+ * threads without locks: a slot is two atomic words, the data and the key XOR
+ * the data, so a slot torn by two threads writing at once reads as a miss.
+ */
+class TranspositionTable
+{
+public:
+	enum Bound : std::uint8_t {
+		None,
+		Exact,  ///< Score is the true minimax value
+		Lower,  ///< Search failed high, the value is at least score
+		Upper   ///< Search failed low, the value is at most score
+	};
+
+	/**
+	 * @param megabytes Table size, rounded down to a power of two entries.
+	 */
+	explicit TranspositionTable(std::size_t megabytes = 16);
+
+	/**
+	 * @brief Reallocates the table, dropping every entry.
+	 */
+	void resize(std::size_t megabytes);
+
+	/**
+	 * @brief Forgets every entry and resets the statistics.
+	 */
+	void clear();
+
+	/**
+	 * @brief Looks up a position.
+	 * @param entry Filled with the stored result on a hit.
+	 * @return false if the slot holds a different position.
+	 */
+	bool probe(std::uint64_t key, TTEntry& entry) const;
+
+	/**
+	 * @brief Stores a search result.
+	 * @param move Best move in packMove format, 0 if none.
+	 */
+	void store(std::uint64_t key, int score, int depth, Bound bound, std::uint16_t move = 0);
+
+	/**
+	 * @brief Number of entries the table holds.
+	 */
+	std::size_t getCapacity() const;
+
+	/**
+	 * @brief Used slots per thousand, sampled from the first thousand slots.
+	 */
+	int getPermilleFull() const;
+
+private:
+	struct Slot {
+		std::atomic<std::uint64_t> check;   ///< key ^ data
+		std::atomic<std::uint64_t> data;    ///< score, depth, bound and move packed together
+	};
+
+	std::unique_ptr<Slot[]> m_slots;
+	std::size_t m_capacity;
+	std::uint64_t m_mask;
+};
@@ -15,15 +15,22 @@
 #pragma comment(lib,"sfml-network.lib") 
 #endif 
 
-#include <iostream>
+#include <cstdlib>
 #include "Game.h"
+#include "CommandLine.h"
 
 /// <summary>
 /// main enrtry point
+/// Run with a command name to use a headless tool instead of opening the window,
+/// the commands are listed in CommandLine.h
 /// </summary>
 /// <returns>success or failure</returns>
-int main()
+int main(int argc, char* argv[])
 {
+	int exitCode = EXIT_SUCCESS;
+	if (CommandLine::dispatch(argc, argv, exitCode))
+		return exitCode;
+
 	Game game;
 	game.run();
 
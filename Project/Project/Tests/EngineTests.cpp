@@ -0,0 +1,418 @@
+#include "EngineProtocol.h"
+#include "Gameplay.h"
+#include "PositionString.h"
+#include "SearchBench.h"
+#include "SkillLevel.h"
+#include "TimeManager.h"
+#include "TrainingData.h"
+#include "TranspositionTable.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+/**
+ * @file EngineTests.cpp
+ * @brief Unit tests of the rules and the search, built without SFML.
+ *
+ * Usage: engine_tests [test name...]
+ * Runs every test, or only the ones named. Exits with 1 if any check failed.
+ */
+
+static int g_failures = 0;
+
+/// Reports a failed condition and carries on with the test.
+#define CHECK(condition) \
+	do { \
+		if (!(condition)) { \
+			std::cout << "  " << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+			g_failures++; \
+		} \
+	} while (0)
+
+/**
+ * @brief Parses a position the test relies on, failing the test if it does not parse.
+ */
+static Boardstate parsePosition(const char* text)
+{
+	Boardstate state;
+	Hand hand;
+	bool parsed = PositionString::parse(text, state, hand);
+	CHECK(parsed);
+	return state;
+}
+
+static bool sameMove(const Move& a, const Move& b)
+{
+	return a.row1 == b.row1 && a.col1 == b.col1 && a.row2 == b.row2 && a.col2 == b.col2;
+}
+
+static void testPositionString()
+{
+	const char* text = "2D2/1s3/5/3F1/d4 1 SDDfdd";
+	Boardstate state;
+	Hand hand;
+	CHECK(PositionString::parse(text, state, hand));
+	CHECK(PositionString::toString(state, hand) == text);
+	CHECK(state.currentPlayer == Player::Player1);
+	CHECK(state.grid[0][2].owner == Player::Player1 && state.grid[0][2].type == AnimalType::Donkey);
+	CHECK(state.grid[1][1].owner == Player::Player2 && state.grid[1][1].type == AnimalType::Snake);
+	CHECK(hand.count[Player::Player2][AnimalType::Donkey] == 2);
+
+	CHECK(!PositionString::parse("2D2/1s3/5/3F1 1 -", state, hand));      // Four rows
+	CHECK(!PositionString::parse("2D2/1s3/5/3F1/d5 1 -", state, hand));   // Six cells
+	CHECK(!PositionString::parse("2D2/1s3/5/3F1/d4 3 -", state, hand));   // No player 3
+	CHECK(!PositionString::parse("2D2/1s3/5/3X1/d4 1 -", state, hand));   // No animal X
+	CHECK(!PositionString::parse("5/5/5/5/5 1 FF", state, hand));         // Two frogs in hand
+
+	CHECK(sameMove(PositionString::parseMove("b2c3"), Move(1, 1, 2, 2)));
+	CHECK(PositionString::moveText(Move(1, 1, 2, 2)) == "b2c3");
+	CHECK(!PositionString::parseMove("f1a1").isValid());
+}
+
+static void testMoveRules()
+{
+	Gameplay rules;
+	MoveList moves;
+
+	// A donkey in the corner: down and right
+	Boardstate corner = parsePosition("D4/5/5/5/5 1 -");
+	rules.getValidMovesForPiece(0, 0, corner, moves);
+	CHECK(moves.size() == 2);
+
+	// A snake in the middle: all eight neighbours
+	Boardstate middle = parsePosition("5/5/2S2/5/5 1 -");
+	rules.getValidMovesForPiece(2, 2, middle, moves);
+	CHECK(moves.size() == 8);
+
+	// A frog steps down or diagonally, or jumps the donkey next to it
+	Boardstate jump = parsePosition("FD3/5/5/5/5 1 -");
+	rules.getValidMovesForPiece(0, 0, jump, moves);
+	CHECK(moves.size() == 3);
+	CHECK(std::any_of(moves.begin(), moves.end(), [](const Move& move) { return sameMove(move, Move(0, 0, 0, 2)); }));
+
+	// Only the side to move's pieces move
+	rules.generateMoves(jump, moves);
+	CHECK(moves.size() == 5);
+	jump.currentPlayer = Player::Player2;
+	rules.generateMoves(jump, moves);
+	CHECK(moves.empty());
+}
+
+static void testWinCondition()
+{
+	Gameplay rules;
+	Player winner = Player::NoPlayer;
+
+	CHECK(rules.checkWimCondition(parsePosition("FDDD1/5/5/5/5 2 -"), winner));
+	CHECK(winner == Player::Player1);
+	CHECK(rules.checkWimCondition(parsePosition("s4/1d3/2f2/3d1/5 1 -"), winner));
+	CHECK(winner == Player::Player2);
+	CHECK(!rules.checkWimCondition(parsePosition("FDD1D/5/5/5/5 2 -"), winner));
+	CHECK(!rules.checkWimCondition(parsePosition("FDdD1/5/5/5/5 2 -"), winner));
+}
+
+static void testThreatSearch()
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+
+	// The snake steps up next to three donkeys
+	Boardstate state = parsePosition("DDD2/3S1/5/d1f1s/d3d 1 -");
+	Move move;
+	CHECK(rules.findThreatWin(state, 0, move));
+	CHECK(sameMove(move, Move(1, 3, 0, 3)));
+
+	Player winner = Player::NoPlayer;
+	CHECK(rules.checkWimCondition(rules.makeMove(state, move), winner) && winner == Player::Player1);
+	CHECK(sameMove(rules.chooseBestMove(state, 2), move));
+	CHECK(rules.getLastScore() == UNLIMITED_POWER);
+
+	// The suite positions have no win by threats, for either side
+	for (int index = 0; index < SearchBench::POSITION_COUNT; ++index) {
+		CHECK(!rules.findThreatWin(parsePosition(SearchBench::position(index)), 2, move));
+	}
+}
+
+static void testSlicedSearch()
+{
+	Gameplay whole, sliced;
+	whole.setVerbose(false);
+	sliced.setVerbose(false);
+
+	for (int index = 0; index < SearchBench::POSITION_COUNT; ++index)
+	{
+		Boardstate state = parsePosition(SearchBench::position(index));
+
+		whole.setSeed(1);
+		Move expected = whole.chooseBestMove(state, 2);
+
+		// Tiny slices, so the search is left and picked up again many times
+		sliced.setSeed(1);
+		sliced.beginSearch(state, 2);
+		int slices = 1;
+		while (!sliced.continueSearch(7, std::chrono::steady_clock::time_point::max())) {
+			slices++;
+		}
+
+		CHECK(slices > 1);
+		CHECK(!sliced.isSearching());
+		CHECK(sameMove(sliced.getSearchResult(), expected));
+		CHECK(sliced.getLastScore() == whole.getLastScore());
+		CHECK(sliced.getNodesEvaluated() == whole.getNodesEvaluated());
+	}
+}
+
+static void testMultiPv()
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+
+	for (int index = 0; index < SearchBench::POSITION_COUNT; ++index)
+	{
+		Boardstate state = parsePosition(SearchBench::position(index));
+		rules.chooseBestMove(state, 2);
+		int best = rules.getLastScore();
+
+		// Every root move searched with a full window scores the best three exactly
+		std::vector<ScoredMove> lines = rules.chooseBestMoves(state, 2, 3);
+		std::vector<ScoredMove> all = rules.chooseBestMoves(state, 2, MoveList::CAPACITY);
+
+		CHECK(lines.size() == 3);
+		CHECK(lines[0].score == best);
+		for (std::size_t line = 0; line < lines.size(); ++line) {
+			CHECK(lines[line].score == all[line].score);
+			CHECK(line == 0 || lines[line - 1].score >= lines[line].score);
+		}
+	}
+}
+
+static void testScoreMove()
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+
+	// A move searched on its own scores as it does among all root moves, for either side to move
+	for (int index = 0; index < SearchBench::POSITION_COUNT; ++index)
+	{
+		Boardstate state = parsePosition(SearchBench::position(index));
+		std::vector<ScoredMove> all = rules.chooseBestMoves(state, 2, MoveList::CAPACITY);
+		for (const ScoredMove& line : all) {
+			CHECK(rules.scoreMove(state, line.move, 2) == line.score);
+		}
+	}
+}
+
+static void testTranspositionTable()
+{
+	TranspositionTable table(1);
+	const std::uint64_t key = 0x0123456789abcdefull;
+	table.store(key, -123, 5, TranspositionTable::Lower, packMove(Move(1, 2, 3, 4), BOARD_SIZE));
+
+	TTEntry entry;
+	CHECK(table.probe(key, entry));
+	CHECK(entry.score == -123);
+	CHECK(entry.depth == 5);
+	CHECK(entry.bound == TranspositionTable::Lower);
+	CHECK(sameMove(unpackMove(entry.move, BOARD_SIZE), Move(1, 2, 3, 4)));
+	CHECK(!table.probe(key ^ 1, entry));
+
+	table.clear();
+	CHECK(!table.probe(key, entry));
+}
+
+static void testShardWriter()
+{
+	std::vector<TrainingRecord> records(5, TrainingRecord::fromBoardstate(parsePosition(SearchBench::position(0)), 10, 0, 0));
+
+	// Two records a shard, so the five go into three files
+	{
+		ShardWriter writer("engine_tests_shard", 2, 4);
+		writer.write(records.data(), records.size());
+		writer.close();
+		CHECK(!writer.hasFailed());
+		CHECK(writer.getRecordsWritten() == records.size());
+	}
+	for (const char* path : { "engine_tests_shard-0000.bin", "engine_tests_shard-0001.bin", "engine_tests_shard-0002.bin" }) {
+		CHECK(std::remove(path) == 0);
+	}
+
+	// A shard that cannot be opened counts nothing as written
+	ShardWriter writer("no-such-directory/engine_tests_shard", 2, 4);
+	writer.write(records.data(), records.size());
+	writer.close();
+	CHECK(writer.hasFailed());
+	CHECK(writer.getRecordsWritten() == 0);
+}
+
+static void testSearchLimits()
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+	rules.setThreatDepth(0);
+
+	SearchLimits limits;
+	limits.nodes = 100;
+	rules.setSearchLimits(limits);
+
+	Boardstate state = parsePosition(SearchBench::position(0));
+	rules.chooseBestMove(state, 6);
+	CHECK(rules.wasStopped());
+
+	// On the way out each node of the path calls its remaining moves once, and they return at once
+	CHECK(rules.getNodesEvaluated() < limits.nodes + 7 * MoveList::CAPACITY);
+}
+
+static void testSkillLevel()
+{
+	Gameplay rules;
+	rules.setVerbose(false);
+	CHECK(!SkillLevel().isEnabled());
+
+	for (int level = 0; level < SkillLevel::MAX_LEVEL; level += 6)
+	{
+		SkillLevel skill(level), again(level);
+		CHECK(skill.isEnabled());
+
+		for (int index = 0; index < SearchBench::POSITION_COUNT; ++index)
+		{
+			Boardstate state = parsePosition(SearchBench::position(index));
+			skill.setSeed(index);
+			again.setSeed(index);
+			Move move = skill.chooseMove(rules, state, SearchLimits());
+			CHECK(sameMove(again.chooseMove(rules, state, SearchLimits()), move));
+
+			MoveList legal;
+			rules.generateMoves(state, legal);
+			CHECK(std::any_of(legal.begin(), legal.end(), [&move](const Move& other) { return sameMove(other, move); }));
+
+			// The first iteration always finishes, past it the budget holds as a node limit does
+			CHECK(skill.getNodesSearched() < std::max<std::uint64_t>(skill.getNodeBudget(), legal.size())
+				+ (level + 2) * MoveList::CAPACITY);
+		}
+	}
+}
+
+static void testDrawRules()
+{
+	DrawRules rules;
+	CHECK(rules.isDraw({ 1, 2, 1, 2, 1 }, 4));
+	CHECK(!rules.isDraw({ 1, 2, 1, 2 }, 3));
+	CHECK(rules.isDraw({ 1, 2 }, rules.maxMovementPlies));
+
+	Boardstate state = parsePosition(SearchBench::position(0));
+	Boardstate other = state;
+	other.currentPlayer = (state.currentPlayer == Player::Player1) ? Player::Player2 : Player::Player1;
+	CHECK(Gameplay::positionKey(state) != Gameplay::positionKey(other));
+}
+
+/**
+ * @brief Nodes of the bench at its depth. A change that is meant to alter the search (pruning,
+ *        ordering, evaluation) updates this to the new "Nodes searched" of engine_bench, in the
+ *        same commit; one that is not meant to must leave it alone.
+ */
+static const std::uint64_t BENCH_SIGNATURE = 477386;
+
+static void testBenchSignature()
+{
+	std::uint64_t nodes = SearchBench::signature(SearchBench::BENCH_DEPTH);
+	if (nodes != BENCH_SIGNATURE) {
+		std::cout << "  bench signature " << nodes << ", expected " << BENCH_SIGNATURE << "\n";
+	}
+	CHECK(nodes == BENCH_SIGNATURE);
+}
+
+static void testTimeManager()
+{
+	TimeControl control;
+	control.baseMs = 10000;
+	control.incrementMs = 500;
+	TimeManager clock(control);
+
+	clock.startMove(Player::Player1, 1, 0, 200, false);
+	CHECK(clock.isInstant());
+	clock.endMove();
+	CHECK(clock.getRemainingMs(Player::Player1) >= 10000);
+
+	clock.startMove(Player::Player2, 20, 0, 200, false);
+	CHECK(!clock.isInstant());
+	CHECK(clock.getHardDeadline() > std::chrono::steady_clock::now());
+	CHECK(clock.getHardDeadline() < std::chrono::steady_clock::now() + std::chrono::milliseconds(10000));
+	CHECK(clock.shouldDeepen(false));
+}
+
+/**
+ * @brief Runs the protocol on the commands, returns everything it answered.
+ */
+static std::string runProtocol(const std::string& commands)
+{
+	std::istringstream in(commands);
+	std::ostringstream out;
+	EngineProtocol engine(in, out);
+	engine.run();
+	return out.str();
+}
+
+static void testEngineProtocol()
+{
+	std::string answer = runProtocol(std::string("position ") + SearchBench::position(0) + "\ngo depth 2\nquit\n");
+	CHECK(answer.find("bestmove ") != std::string::npos);
+	CHECK(answer.find("bestmove none") == std::string::npos);
+
+	// Pieces left to place: no board move is legal, so there is no bestmove to give
+	answer = runProtocol("position 2D2/1s3/5/3F1/d4 1 SDDfdd\ngo depth 2\nquit\n");
+	CHECK(answer.find("info string cannot search the placement phase") != std::string::npos);
+	CHECK(answer.find("bestmove") == std::string::npos);
+
+	// Four donkeys between board and hand
+	answer = runProtocol("position 2D2/1s3/5/3F1/d4 1 SDDDfdd\nquit\n");
+	CHECK(answer.find("info string invalid position") != std::string::npos);
+}
+
+struct TestCase {
+	const char* name;
+	void (*run)();
+};
+
+static const TestCase TESTS[] = {
+	{ "position-string", testPositionString },
+	{ "move-rules", testMoveRules },
+	{ "win-condition", testWinCondition },
+	{ "threat-search", testThreatSearch },
+	{ "sliced-search", testSlicedSearch },
+	{ "multi-pv", testMultiPv },
+	{ "score-move", testScoreMove },
+	{ "transposition-table", testTranspositionTable },
+	{ "shard-writer", testShardWriter },
+	{ "search-limits", testSearchLimits },
+	{ "skill-level", testSkillLevel },
+	{ "draw-rules", testDrawRules },
+	{ "time-manager", testTimeManager },
+	{ "bench-signature", testBenchSignature },
+	{ "engine-protocol", testEngineProtocol },
+};
+
+int main(int argc, char* argv[])
+{
+	int run = 0;
+	for (const TestCase& test : TESTS)
+	{
+		bool wanted = argc < 2;
+		for (int arg = 1; arg < argc; ++arg) {
+			wanted = wanted || std::strcmp(argv[arg], test.name) == 0;
+		}
+		if (!wanted)
+			continue;
+
+		int before = g_failures;
+		test.run();
+		std::cout << test.name << (g_failures == before ? " ok\n" : " FAILED\n");
+		run++;
+	}
+
+	std::cout << run << " tests, " << g_failures << " failed checks\n";
+	return (g_failures == 0 && run > 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}